@@ -0,0 +1,50 @@
+#define OK_IMPLEMENTATION
+#include "../ok.hpp"
+#include "bench.hpp"
+
+using namespace ok;
+
+static constexpr size_t OPS = 100'000;
+
+// small allocations of mixed sizes, like the nodes and strings of a parser
+static inline size_t alloc_size(size_t i) {
+    return 8 + (i & 7) * 8;
+}
+
+int main() {
+    bench::print_header("allocators");
+
+    ArenaAllocator arena{};
+    auto ok_arena = bench::run("ArenaAllocator::alloc", OPS, [&](size_t ops) {
+        for (size_t i = 0; i < ops; i++) bench::keep(arena.raw_alloc(alloc_size(i)));
+        arena.reset();
+    });
+
+    void** ptrs = (void**)malloc(OPS * sizeof(void*));
+    auto std_malloc = bench::run("malloc + free", OPS, [&](size_t ops) {
+        for (size_t i = 0; i < ops; i++) ptrs[i] = malloc(alloc_size(i));
+        for (size_t i = 0; i < ops; i++) free(ptrs[i]);
+    });
+    bench::compare(ok_arena, std_malloc);
+
+    FixedBufferAllocator fixed{};
+    auto ok_fixed = bench::run("FixedBufferAllocator::alloc", OPS, [&](size_t ops) {
+        for (size_t i = 0; i < ops; i++) bench::keep(fixed.raw_alloc(alloc_size(i)));
+        fixed.buffer_off = 0;
+    });
+    bench::compare(ok_fixed, std_malloc);
+
+    PoolAllocator pool{};
+    auto ok_pool = bench::run("PoolAllocator::alloc + dealloc", OPS, [&](size_t ops) {
+        for (size_t i = 0; i < ops; i++) ptrs[i] = pool.raw_alloc(alloc_size(i));
+        for (size_t i = 0; i < ops; i++) pool.raw_dealloc(ptrs[i], alloc_size(i));
+    });
+    bench::compare(ok_pool, std_malloc);
+
+    free(ptrs);
+    pool.free();
+    fixed.free();
+    arena.free();
+
+    return 0;
+}
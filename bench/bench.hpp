@@ -0,0 +1,193 @@
+#ifndef OK_BENCH_H_
+#define OK_BENCH_H_
+
+// A minimal timing harness. Every benchmark body runs a fixed number of operations per repetition,
+// the repetitions are timed separately and reported as the median and 99th percentile time per op.
+// The including file defines OK_IMPLEMENTATION and includes ok.hpp before this header.
+
+#include <chrono>
+
+#if defined(__x86_64__) || defined(_M_X64)
+#define OK_BENCH_RDTSC 1
+#ifdef _MSC_VER
+#include <intrin.h>
+#else
+#include <x86intrin.h>
+#endif // _MSC_VER
+#else
+#define OK_BENCH_RDTSC 0
+#endif // rdtsc check
+
+#if defined(__linux__)
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif // __linux__
+
+namespace bench {
+
+static constexpr size_t WARMUP_REPETITIONS = 3;
+static constexpr size_t REPETITIONS = 31;
+
+// Keeps the compiler from optimizing away a computed value
+template <typename T>
+inline void keep(const T& value) {
+#if defined(__GNUC__)
+    asm volatile("" : : "r,m"(value) : "memory");
+#else
+    static volatile const void* sink;
+    sink = &value;
+#endif // __GNUC__
+}
+
+static inline uint64_t now_ns() {
+    auto since_epoch = std::chrono::steady_clock::now().time_since_epoch();
+    return (uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(since_epoch).count();
+}
+
+static inline uint64_t cycles() {
+#if OK_BENCH_RDTSC
+    return __rdtsc();
+#else
+    return 0;
+#endif // OK_BENCH_RDTSC
+}
+
+// Counts retired instructions of the calling thread. Opening it fails in most containers,
+// in which case the column is left out
+struct InstructionCounter {
+    static inline InstructionCounter open() {
+        InstructionCounter counter{-1};
+
+#if defined(__linux__)
+        perf_event_attr attr{};
+        attr.type = PERF_TYPE_HARDWARE;
+        attr.size = sizeof(attr);
+        attr.config = PERF_COUNT_HW_INSTRUCTIONS;
+        attr.disabled = 1;
+        attr.exclude_kernel = 1;
+        attr.exclude_hv = 1;
+
+        counter.fd = (int)syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0);
+#endif // __linux__
+
+        return counter;
+    }
+
+    inline bool valid() const {
+        return fd >= 0;
+    }
+
+    inline void start() {
+#if defined(__linux__)
+        if (!valid()) return;
+        ioctl(fd, PERF_EVENT_IOC_RESET, 0);
+        ioctl(fd, PERF_EVENT_IOC_ENABLE, 0);
+#endif // __linux__
+    }
+
+    inline uint64_t stop() {
+        uint64_t count = 0;
+
+#if defined(__linux__)
+        if (!valid()) return 0;
+        ioctl(fd, PERF_EVENT_IOC_DISABLE, 0);
+        if (read(fd, &count, sizeof(count)) != (ssize_t)sizeof(count)) count = 0;
+#endif // __linux__
+
+        return count;
+    }
+
+    inline void close() {
+#if defined(__linux__)
+        if (valid()) ::close(fd);
+#endif // __linux__
+        fd = -1;
+    }
+
+    int fd;
+};
+
+struct Result {
+    double median_ns;
+    double p99_ns;
+    double ops_per_second;
+    double cycles_per_op;
+    double instructions_per_op;
+};
+
+static inline void print_header(const char* group) {
+    printf("\n%-40s %12s %12s %14s %10s %10s\n", group, "median ns/op", "p99 ns/op", "ops/s", "cycles/op", "instr/op");
+}
+
+static inline void print_result(const char* name, const Result& result) {
+    printf("%-40s %12.2f %12.2f %14.0f", name, result.median_ns, result.p99_ns, result.ops_per_second);
+
+    if (OK_BENCH_RDTSC) printf(" %10.2f", result.cycles_per_op);
+    else printf(" %10s", "-");
+
+    if (result.instructions_per_op > 0.0) printf(" %10.2f\n", result.instructions_per_op);
+    else printf(" %10s\n", "-");
+}
+
+// Runs `body(ops)` for the warmup and timed repetitions, where `body` performs `ops` operations
+template <typename F>
+Result run(const char* name, size_t ops, F body) {
+    for (size_t i = 0; i < WARMUP_REPETITIONS; i++) body(ops);
+
+    double samples[REPETITIONS];
+    uint64_t total_cycles = 0;
+    uint64_t total_instructions = 0;
+
+    InstructionCounter counter = InstructionCounter::open();
+
+    for (size_t i = 0; i < REPETITIONS; i++) {
+        counter.start();
+        uint64_t start_cycles = cycles();
+        uint64_t start = now_ns();
+
+        body(ops);
+
+        uint64_t elapsed = now_ns() - start;
+        total_cycles += cycles() - start_cycles;
+        total_instructions += counter.stop();
+
+        samples[i] = (double)elapsed / (double)ops;
+    }
+
+    counter.close();
+
+    ok::sort(samples, REPETITIONS);
+
+    Result result;
+    result.median_ns = samples[REPETITIONS / 2];
+    result.p99_ns = samples[(REPETITIONS * 99 + 99) / 100 - 1];
+    result.ops_per_second = result.median_ns > 0.0 ? 1e9 / result.median_ns : 0.0;
+    result.cycles_per_op = (double)total_cycles / (double)(REPETITIONS * ops);
+    result.instructions_per_op = (double)total_instructions / (double)(REPETITIONS * ops);
+
+    print_result(name, result);
+    return result;
+}
+
+// Prints how much faster `ours` is than `theirs`
+static inline void compare(const Result& ours, const Result& theirs) {
+    printf("%-40s %11.2fx\n", "  speedup over std", theirs.median_ns / ours.median_ns);
+}
+
+// Deterministic xorshift so every run sees the same inputs
+struct Random {
+    inline uint64_t next() {
+        state ^= state << 13;
+        state ^= state >> 7;
+        state ^= state << 17;
+        return state;
+    }
+
+    uint64_t state;
+};
+
+} // namespace bench
+
+#endif // OK_BENCH_H_
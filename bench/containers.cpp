@@ -0,0 +1,168 @@
+#define OK_IMPLEMENTATION
+#include "../ok.hpp"
+#include "bench.hpp"
+
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+using namespace ok;
+
+static constexpr size_t PUSH_OPS = 1'000'000;
+static constexpr size_t TABLE_OPS = 100'000;
+
+int main() {
+    bench::print_header("List");
+
+    ArenaAllocator arena{};
+
+    auto ok_push = bench::run("List<int>::push", PUSH_OPS, [&](size_t ops) {
+        auto list = List<int>::alloc(&arena);
+        for (size_t i = 0; i < ops; i++) list.push((int)i);
+        bench::keep(list.items);
+        arena.reset();
+    });
+
+    auto std_push = bench::run("std::vector<int>::push_back", PUSH_OPS, [&](size_t ops) {
+        std::vector<int> vector;
+        for (size_t i = 0; i < ops; i++) vector.push_back((int)i);
+        bench::keep(vector.data());
+    });
+    bench::compare(ok_push, std_push);
+
+    // the same loop with the allocator type known at compile time, so the growth path inlines
+    auto arena_push = bench::run("List<int, ArenaAllocator>::push", PUSH_OPS, [&](size_t ops) {
+        auto list = List<int, ArenaAllocator>::alloc(&arena);
+        for (size_t i = 0; i < ops; i++) list.push((int)i);
+        bench::keep(list.items);
+        arena.reset();
+    });
+    bench::compare(arena_push, std_push);
+
+    bench::Random random{0x9E3779B97F4A7C15ull};
+
+    int64_t* int_keys = (int64_t*)malloc(TABLE_OPS * sizeof(int64_t));
+    for (size_t i = 0; i < TABLE_OPS; i++) int_keys[i] = (int64_t)random.next();
+
+    bench::print_header("Table with integer keys");
+
+    auto ok_int_put = bench::run("Table<int64_t, int64_t>::put", TABLE_OPS, [&](size_t ops) {
+        auto table = Table<int64_t, int64_t>::alloc(&arena);
+        for (size_t i = 0; i < ops; i++) table.put(int_keys[i], (int64_t)i);
+        bench::keep(table.count);
+        arena.reset();
+    });
+
+    auto std_int_put = bench::run("std::unordered_map<int64_t>::insert", TABLE_OPS, [&](size_t ops) {
+        std::unordered_map<int64_t, int64_t> map;
+        for (size_t i = 0; i < ops; i++) map[int_keys[i]] = (int64_t)i;
+        bench::keep(map.size());
+    });
+    bench::compare(ok_int_put, std_int_put);
+
+    auto int_table = Table<int64_t, int64_t>::alloc(&arena);
+    std::unordered_map<int64_t, int64_t> int_map;
+    for (size_t i = 0; i < TABLE_OPS; i++) {
+        int_table.put(int_keys[i], (int64_t)i);
+        int_map[int_keys[i]] = (int64_t)i;
+    }
+
+    auto ok_int_get = bench::run("Table<int64_t, int64_t>::get", TABLE_OPS, [&](size_t ops) {
+        for (size_t i = 0; i < ops; i++) bench::keep(int_table.get(int_keys[i]).get());
+    });
+
+    auto std_int_get = bench::run("std::unordered_map<int64_t>::find", TABLE_OPS, [&](size_t ops) {
+        for (size_t i = 0; i < ops; i++) bench::keep(int_map.find(int_keys[i])->second);
+    });
+    bench::compare(ok_int_get, std_int_get);
+
+    bench::print_header("Table<uint32_t, uint64_t> layouts");
+
+    // big enough to fall out of the caches, where the layout matters the most
+    static constexpr size_t LAYOUT_COUNT = 1 << 20;
+
+    uint32_t* small_keys = (uint32_t*)malloc(LAYOUT_COUNT * sizeof(uint32_t));
+    for (size_t i = 0; i < LAYOUT_COUNT; i++) small_keys[i] = (uint32_t)random.next();
+
+    auto soa = Table<uint32_t, uint64_t, TableLayout::SOA>::alloc(&arena);
+    auto aos = Table<uint32_t, uint64_t, TableLayout::AOS>::alloc(&arena);
+    for (size_t i = 0; i < LAYOUT_COUNT; i++) {
+        soa.put(small_keys[i], i);
+        aos.put(small_keys[i], i);
+    }
+
+    auto soa_get = bench::run("get, TableLayout::SOA", TABLE_OPS, [&](size_t ops) {
+        for (size_t i = 0; i < ops; i++) bench::keep(*soa.get_ptr(small_keys[(i * 7919) & (LAYOUT_COUNT - 1)]));
+    });
+
+    auto aos_get = bench::run("get, TableLayout::AOS", TABLE_OPS, [&](size_t ops) {
+        for (size_t i = 0; i < ops; i++) bench::keep(*aos.get_ptr(small_keys[(i * 7919) & (LAYOUT_COUNT - 1)]));
+    });
+    printf("%-40s %11.2fx\n", "  AOS speedup over SOA", soa_get.median_ns / aos_get.median_ns);
+
+    auto soa_iter = bench::run("iterate, TableLayout::SOA", LAYOUT_COUNT, [&](size_t) {
+        uint64_t sum = 0;
+        OK_TABLE_FOREACH(soa, key, value, { sum += key + value; });
+        bench::keep(sum);
+    });
+
+    auto aos_iter = bench::run("iterate, TableLayout::AOS", LAYOUT_COUNT, [&](size_t) {
+        uint64_t sum = 0;
+        OK_TABLE_FOREACH(aos, key, value, { sum += key + value; });
+        bench::keep(sum);
+    });
+    printf("%-40s %11.2fx\n", "  AOS speedup over SOA", soa_iter.median_ns / aos_iter.median_ns);
+
+    free(small_keys);
+    arena.reset();
+
+    // the string keys outlive the tables, so they are kept in a separate arena
+    ArenaAllocator key_arena{};
+    StringView* string_keys = key_arena.alloc<StringView>(TABLE_OPS);
+    std::string* std_string_keys = new std::string[TABLE_OPS];
+
+    for (size_t i = 0; i < TABLE_OPS; i++) {
+        String key = format(&key_arena, "user:{}:session", random.next() % 1'000'000'000);
+        string_keys[i] = StringView{key.data(), key.count()};
+        std_string_keys[i] = std::string{key.data(), key.count()};
+    }
+
+    bench::print_header("Table with string keys");
+
+    auto ok_string_put = bench::run("Table<StringView, size_t>::put", TABLE_OPS, [&](size_t ops) {
+        auto table = Table<StringView, size_t>::alloc(&arena);
+        for (size_t i = 0; i < ops; i++) table.put(string_keys[i], i);
+        bench::keep(table.count);
+        arena.reset();
+    });
+
+    auto std_string_put = bench::run("std::unordered_map<std::string>::insert", TABLE_OPS, [&](size_t ops) {
+        std::unordered_map<std::string, size_t> map;
+        for (size_t i = 0; i < ops; i++) map[std_string_keys[i]] = i;
+        bench::keep(map.size());
+    });
+    bench::compare(ok_string_put, std_string_put);
+
+    auto string_table = Table<StringView, size_t>::alloc(&arena);
+    std::unordered_map<std::string, size_t> string_map;
+    for (size_t i = 0; i < TABLE_OPS; i++) {
+        string_table.put(string_keys[i], i);
+        string_map[std_string_keys[i]] = i;
+    }
+
+    auto ok_string_get = bench::run("Table<StringView, size_t>::get", TABLE_OPS, [&](size_t ops) {
+        for (size_t i = 0; i < ops; i++) bench::keep(string_table.get(string_keys[i]).get());
+    });
+
+    auto std_string_get = bench::run("std::unordered_map<std::string>::find", TABLE_OPS, [&](size_t ops) {
+        for (size_t i = 0; i < ops; i++) bench::keep(string_map.find(std_string_keys[i])->second);
+    });
+    bench::compare(ok_string_get, std_string_get);
+
+    delete[] std_string_keys;
+    free(int_keys);
+    key_arena.free();
+    arena.free();
+
+    return 0;
+}
@@ -0,0 +1,59 @@
+#define OK_IMPLEMENTATION
+#include "../ok.hpp"
+#include "bench.hpp"
+
+#include <atomic>
+#include <filesystem>
+
+using namespace ok;
+
+// a tree that exists on every Linux system and is big enough to take a while
+static const char* ROOT = "/usr/include";
+
+int main() {
+    std::atomic<size_t> entry_count{0};
+    auto count_entries = [&](const DirectoryWalker::Entry& entry) {
+        OK_UNUSED(entry);
+        entry_count.fetch_add(1, std::memory_order_relaxed);
+        return true;
+    };
+
+    if (DirectoryWalker::walk(ROOT, count_entries, 1).has_value()) {
+        printf("%s cannot be listed, skipping\n", ROOT);
+        return 0;
+    }
+
+    // every repetition lists the same tree, so one op is one entry
+    size_t ops = entry_count.load();
+
+    bench::print_header("walking /usr/include");
+
+    auto ok_walk = bench::run("DirectoryWalker::walk, 1 thread", ops, [&](size_t) {
+        entry_count = 0;
+        DirectoryWalker::walk(ROOT, count_entries, 1);
+        bench::keep(entry_count.load());
+    });
+
+    bench::run("DirectoryWalker::walk, every core", ops, [&](size_t) {
+        entry_count = 0;
+        DirectoryWalker::walk(ROOT, count_entries);
+        bench::keep(entry_count.load());
+    });
+
+    auto std_walk = bench::run("std::recursive_directory_iterator", ops, [&](size_t) {
+        size_t count = 0;
+        std::error_code error;
+
+        for (auto it = std::filesystem::recursive_directory_iterator(ROOT, error);
+             it != std::filesystem::recursive_directory_iterator(); it.increment(error)) {
+            // the type is what the walker reports for free
+            bench::keep(it->is_directory(error));
+            count++;
+        }
+
+        bench::keep(count);
+    });
+    bench::compare(ok_walk, std_walk);
+
+    return 0;
+}
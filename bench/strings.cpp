@@ -0,0 +1,139 @@
+#define OK_IMPLEMENTATION
+#include "../ok.hpp"
+#include "bench.hpp"
+
+#include <charconv>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <string_view>
+
+using namespace ok;
+
+static constexpr size_t HASH_OPS = 100'000;
+static constexpr size_t NUMBER_OPS = 1'000'000;
+static constexpr size_t FILE_OPS = 20;
+static constexpr size_t FILE_SIZE = 4 * 1024 * 1024;
+
+int main() {
+    bench::Random random{0x9E3779B97F4A7C15ull};
+
+    char text[64];
+    for (size_t i = 0; i < sizeof(text); i++) text[i] = (char)('a' + random.next() % 26);
+    StringView view{text, sizeof(text)};
+
+    bench::print_header("hashing 64 bytes");
+
+    auto ok_hash = bench::run("hash::fnv1", HASH_OPS, [&](size_t ops) {
+        for (size_t i = 0; i < ops; i++) {
+            text[0] = (char)i;
+            bench::keep(hash::fnv1(view));
+        }
+    });
+
+    auto std_hash = bench::run("std::hash<std::string_view>", HASH_OPS, [&](size_t ops) {
+        std::hash<std::string_view> hasher;
+        for (size_t i = 0; i < ops; i++) {
+            text[0] = (char)i;
+            bench::keep(hasher(std::string_view{text, sizeof(text)}));
+        }
+    });
+    bench::compare(ok_hash, std_hash);
+
+    bench::print_header("numbers");
+
+    int64_t* numbers = (int64_t*)malloc(NUMBER_OPS * sizeof(int64_t));
+    for (size_t i = 0; i < NUMBER_OPS; i++) numbers[i] = (int64_t)random.next() >> (random.next() % 64);
+
+    ArenaAllocator arena{};
+
+    auto ok_to_string = bench::run("to_string(int64_t)", NUMBER_OPS, [&](size_t ops) {
+        for (size_t i = 0; i < ops; i++) bench::keep(to_string(&arena, numbers[i]).count());
+        arena.reset();
+    });
+
+    auto std_to_string = bench::run("std::to_string(int64_t)", NUMBER_OPS, [&](size_t ops) {
+        for (size_t i = 0; i < ops; i++) bench::keep(std::to_string(numbers[i]).size());
+    });
+    bench::compare(ok_to_string, std_to_string);
+
+    char* digits = (char*)malloc(NUMBER_OPS * MAX_INT_CHARS);
+    StringView* views = (StringView*)malloc(NUMBER_OPS * sizeof(StringView));
+
+    for (size_t i = 0; i < NUMBER_OPS; i++) {
+        char* start = digits + i * MAX_INT_CHARS;
+        views[i] = StringView{start, to_chars(start, numbers[i])};
+    }
+
+    auto ok_parse = bench::run("parse_int64", NUMBER_OPS, [&](size_t ops) {
+        int64_t value = 0;
+        for (size_t i = 0; i < ops; i++) {
+            parse_int64(views[i], &value);
+            bench::keep(value);
+        }
+    });
+
+    auto std_parse = bench::run("std::from_chars(int64_t)", NUMBER_OPS, [&](size_t ops) {
+        int64_t value = 0;
+        for (size_t i = 0; i < ops; i++) {
+            std::from_chars(views[i].data, views[i].data + views[i].count, value);
+            bench::keep(value);
+        }
+    });
+    bench::compare(ok_parse, std_parse);
+
+    auto strtoll_parse = bench::run("strtoll", NUMBER_OPS, [&](size_t ops) {
+        char buffer[MAX_INT_CHARS + 1];
+        for (size_t i = 0; i < ops; i++) {
+            memcpy(buffer, views[i].data, views[i].count);
+            buffer[views[i].count] = '\0';
+            bench::keep(strtoll(buffer, nullptr, 10));
+        }
+    });
+    bench::compare(ok_parse, strtoll_parse);
+
+    const char* path = "bench-read-full.tmp";
+
+    File file;
+    OK_ASSERT(!File::create(&file, path).has_value());
+
+    uint8_t* contents = (uint8_t*)malloc(FILE_SIZE);
+    for (size_t i = 0; i < FILE_SIZE; i++) contents[i] = (uint8_t)random.next();
+    OK_ASSERT(!file.write(contents, FILE_SIZE).has_value());
+    file.close();
+
+    bench::print_header("reading a 4 MiB file");
+
+    auto ok_read = bench::run("File::read_full", FILE_OPS, [&](size_t ops) {
+        for (size_t i = 0; i < ops; i++) {
+            File input;
+            OK_ASSERT(!File::open(&input, path).has_value());
+
+            List<uint8_t> bytes;
+            OK_ASSERT(!input.read_full(&arena, &bytes).has_value());
+            bench::keep(bytes.count);
+
+            input.close();
+            arena.reset();
+        }
+    });
+
+    auto std_read = bench::run("std::ifstream + rdbuf", FILE_OPS, [&](size_t ops) {
+        for (size_t i = 0; i < ops; i++) {
+            std::ifstream input{path, std::ios::binary};
+            std::stringstream bytes;
+            bytes << input.rdbuf();
+            bench::keep(bytes.str().size());
+        }
+    });
+    bench::compare(ok_read, std_read);
+
+    remove(path);
+    free(contents);
+    free(views);
+    free(digits);
+    free(numbers);
+    arena.free();
+
+    return 0;
+}
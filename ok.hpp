@@ -27,19 +27,50 @@
 #ifndef OK_H_
 #define OK_H_
 
+#include <atomic>
 #include <cctype>
 #include <cerrno>
+#include <cmath>
+#include <cstddef>
 #include <cstdarg>
 #include <cstdint>
 #include <cstdio>
 #include <cstdlib>
 #include <cstring>
+#include <ctime>
 #include <fcntl.h>
+#include <new>
+#include <sys/stat.h>
 #include <sys/types.h>
+#include <thread>
+#include <type_traits>
+#include <utility>
+
+// Doubles are formatted and parsed with std::to_chars/from_chars where the standard library has
+// the floating point overloads, the fallback goes through the C library and undoes its locale
+#if defined(__has_include)
+#if __has_include(<charconv>)
+#include <charconv>
+#endif // __has_include(<charconv>)
+#endif // __has_include
+
+#if defined(__cpp_lib_to_chars) && __cpp_lib_to_chars >= 201611L
+#define OK_FLOAT_CHARCONV 1
+#else
+#define OK_FLOAT_CHARCONV 0
+#include <clocale>
+#endif // __cpp_lib_to_chars
+
+namespace ok {
+// Declared up front so that the macros below can write out the calling thread's buffered
+// stdout lines before aborting
+void flush_output();
+} // namespace ok
 
 #ifndef OK_ASSERT
 #define OK_ASSERT(x) do { \
     if (!(x)) { \
+        ::ok::flush_output(); \
         fprintf(stderr, "%s:%d: Assertion failed: %s\n", __FILE__, __LINE__, #x); \
         abort(); \
     } \
@@ -54,16 +85,19 @@
 #define OK_UNUSED(arg) (void)(arg);
 
 #define OK_UNREACHABLE() do { \
+    ::ok::flush_output(); \
     fprintf(stderr, "%s:%d: Encountered unreachable code\n", __FILE__, __LINE__); \
     abort(); \
 } while (0)
 
 #define OK_PANIC(msg) do { \
+    ::ok::flush_output(); \
     fprintf(stderr, "%s:%d: PROGRAM PANICKED: %s\n", __FILE__, __LINE__, (msg)); \
     abort(); \
 } while (0)
 
 #define OK_PANIC_FMT(fmt, ...) do { \
+    ::ok::flush_output(); \
     fprintf(stderr, "%s:%d: PROGRAM PANICKED: " fmt "\n", __FILE__, __LINE__, __VA_ARGS__); \
     abort(); \
 } while (0)
@@ -75,9 +109,45 @@
 #define OK_UNIX 1
 #define OK_WINDOWS 0
 
+#if defined(__linux__)
+#define OK_LINUX 1
+#else
+#define OK_LINUX 0
+#endif // __linux__
+
+#if OK_LINUX && defined(__has_include)
+#if __has_include(<linux/io_uring.h>)
+#define OK_IO_URING 1
+#include <linux/io_uring.h>
+#include <sys/syscall.h>
+#endif // __has_include(<linux/io_uring.h>)
+#endif // OK_LINUX && defined(__has_include)
+
+#ifndef OK_IO_URING
+#define OK_IO_URING 0
+#endif // OK_IO_URING
+
+#include <arpa/inet.h>
+#include <dirent.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
 #include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/uio.h>
 #include <unistd.h>
 
+#if OK_LINUX
+#include <sys/epoll.h>
+#include <sys/syscall.h>
+#define OK_KQUEUE 0
+#elif defined(__APPLE__) || defined(__FreeBSD__) || defined(__OpenBSD__) || defined(__NetBSD__)
+#include <sys/event.h>
+#define OK_KQUEUE 1
+#else
+#include <poll.h>
+#define OK_KQUEUE 0
+#endif // OK_LINUX
+
 #define OK_ALLOC_PAGE(sz) (mmap(NULL, (sz), PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANON, -1, 0))
 #define OK_DEALLOC_PAGE(page, size) (munmap((page), (size)))
 #define OK_ALLOC_SMOL(sz) (sbrk((sz)))
@@ -89,12 +159,23 @@
 
 #define OK_UNIX 0
 #define OK_WINDOWS 1
+#define OK_LINUX 0
+#define OK_IO_URING 0
+#define OK_KQUEUE 0
 
+// winsock2.h has to come before windows.h, which would otherwise pull in the old winsock.h
+#include <winsock2.h>
+#include <ws2tcpip.h>
 #include <windows.h>
 #include <memoryapi.h>
 #include <heapapi.h>
 #include <io.h>
 
+#ifdef _MSC_VER
+#include <intrin.h>
+#pragma comment(lib, "ws2_32.lib")
+#endif // _MSC_VER
+
 #undef max
 #undef min
 
@@ -109,14 +190,163 @@
 #error "Only UNIX-like systems and Windows are supported"
 #endif // platform check
 
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define OK_SSE2 1
+#include <emmintrin.h>
+#else
+#define OK_SSE2 0
+#endif // SSE2 check
+
+#if defined(__AVX2__)
+#define OK_AVX2 1
+#include <immintrin.h>
+#else
+#define OK_AVX2 0
+#endif // AVX2 check
+
+#if !OK_SSE2 && (defined(__ARM_NEON) || defined(_M_ARM64))
+#define OK_NEON 1
+#include <arm_neon.h>
+#else
+#define OK_NEON 0
+#endif // NEON check
+
+// Apple's ARM cores pull in cache lines in 128-byte pairs
+#if defined(__APPLE__) && defined(__aarch64__)
+#define OK_CACHE_LINE_SIZE 128
+#else
+#define OK_CACHE_LINE_SIZE 64
+#endif // cache line size
+
+#if defined(__cpp_consteval)
+#define OK_CONSTEVAL consteval
+#else
+#define OK_CONSTEVAL constexpr
+#endif // __cpp_consteval
+
 #ifdef __GNUC__
 #define ATTRIBUTE_PRINTF(fmt, args) __attribute__((format(printf, fmt, args)))
+#define OK_RETURN_ADDRESS() __builtin_return_address(0)
+#elif defined(_MSC_VER)
+#define ATTRIBUTE_PRINTF(fmt, args)
+#define OK_RETURN_ADDRESS() _ReturnAddress()
 #else
 #define ATTRIBUTE_PRINTF(fmt, args)
+#define OK_RETURN_ADDRESS() nullptr
 #endif // __GNUC__
 
+// Allocators keep AllocatorStats when this is enabled
+#ifndef OK_ALLOCATOR_STATS
+#define OK_ALLOCATOR_STATS 0
+#endif // OK_ALLOCATOR_STATS
+
+// TracingAllocator records the calls going through it when this is enabled
+#ifndef OK_ALLOCATOR_TRACING
+#define OK_ALLOCATOR_TRACING 0
+#endif // OK_ALLOCATOR_TRACING
+
+#if OK_ALLOCATOR_STATS
+#define OK_ALLOCATOR_STAT(call) (stats.call)
+#else
+#define OK_ALLOCATOR_STAT(call) ((void)0)
+#endif // OK_ALLOCATOR_STATS
+
 namespace ok {
+// Counters kept by the arena, fixed buffer, pool, virtual arena and tracing allocators
+// when OK_ALLOCATOR_STATS is enabled. ConcurrentArenaAllocator is not counted, since that would
+// put shared atomics on its fast path. Memory rolled back with restore() is not counted as freed
+struct AllocatorStats {
+    inline size_t live_bytes() const {
+        return bytes_allocated - bytes_freed;
+    }
+
+    // Share of the memory taken from the OS that does not hold live allocations
+    inline double fragmentation() const {
+        if (reserved_bytes == 0) return 0.0;
+        return 1.0 - (double)live_bytes() / (double)reserved_bytes;
+    }
+
+    inline void on_alloc(size_t requested, size_t actual) {
+        bytes_allocated += requested;
+        padding_bytes += actual - requested;
+        allocation_count++;
+        live_count++;
+        if (live_bytes() > peak_bytes) peak_bytes = live_bytes();
+    }
+
+    inline void on_dealloc(size_t size) {
+        bytes_freed += size;
+        if (live_count > 0) live_count--;
+    }
+
+    inline void on_resize(size_t old_size, size_t new_size) {
+        bytes_freed += old_size;
+        bytes_allocated += new_size;
+        if (live_bytes() > peak_bytes) peak_bytes = live_bytes();
+    }
+
+    inline void on_region(size_t size) {
+        region_count++;
+        reserved_bytes += size;
+    }
+
+    inline void on_commit(size_t size) {
+        reserved_bytes += size;
+    }
+
+    inline void on_decommit(size_t size) {
+        reserved_bytes -= size;
+    }
+
+    inline void on_region_release(size_t size) {
+        region_count--;
+        reserved_bytes -= size;
+    }
+
+    // Everything handed out so far was dropped at once
+    inline void on_reset() {
+        bytes_freed = bytes_allocated;
+        live_count = 0;
+    }
+
+    inline void on_release() {
+        on_reset();
+        region_count = 0;
+        reserved_bytes = 0;
+    }
+
+    // requested sizes, so they do not include padding
+    size_t bytes_allocated;
+    size_t bytes_freed;
+    size_t peak_bytes;
+    size_t allocation_count;
+    size_t live_count;
+    // bytes lost to rounding requests up to the allocator's granularity
+    size_t padding_bytes;
+    size_t region_count;
+    // bytes obtained from the OS
+    size_t reserved_bytes;
+};
+
 struct Allocator {
+    // A saved allocation position that can later be rolled back to
+    struct Marker {
+        void* region;
+        size_t off;
+    };
+
+    // Restores the allocation position the allocator had when the scope was entered
+    struct Scope {
+        explicit Scope(Allocator* a) : allocator{a}, marker{a->mark()} {}
+        ~Scope() { allocator->restore(marker); }
+
+        Scope(const Scope&) = delete;
+        Scope& operator =(const Scope&) = delete;
+
+        Allocator* allocator;
+        Marker marker;
+    };
+
     // required methods
     virtual void* raw_alloc(size_t size) = 0;
     virtual void raw_dealloc(void* ptr, size_t size) = 0;
@@ -129,6 +359,15 @@ struct Allocator {
         return new_ptr;
     }
 
+    // Allocators that cannot roll back keep everything allocated after the mark
+    virtual Marker mark() {
+        return Marker{nullptr, 0};
+    }
+
+    virtual void restore(Marker marker) {
+        OK_UNUSED(marker);
+    }
+
     // provided methods
     template <typename T>
     inline T* alloc(size_t size = 1) {
@@ -142,32 +381,129 @@ struct Allocator {
 
     template <typename T>
     inline T* resize(T* ptr, size_t old_size, size_t new_size) {
-        T* new_ptr = alloc<T>(new_size);
-        memcpy((void*)new_ptr, ptr, old_size * sizeof(T));
-        dealloc<T>(ptr, old_size);
-        return new_ptr;
+        return (T*)raw_resize((void*)ptr, old_size * sizeof(T), new_size * sizeof(T));
     }
+
+#if OK_ALLOCATOR_STATS
+    AllocatorStats stats;
+#endif // OK_ALLOCATOR_STATS
 };
 
-extern Allocator* temp_allocator;
+// The provided Allocator methods for containers that are parameterized on the allocator type.
+// Called with a final allocator they skip the vtable, letting the fast path inline into the caller
+template <typename T, typename A>
+inline T* allocator_alloc(A* a, size_t count = 1) {
+    return (T*)a->raw_alloc(sizeof(T) * count);
+}
+
+template <typename T, typename A>
+inline void allocator_dealloc(A* a, T* ptr, size_t count) {
+    a->raw_dealloc((void*)ptr, count * sizeof(T));
+}
+
+template <typename T, typename A>
+inline T* allocator_resize(A* a, T* ptr, size_t old_count, size_t new_count) {
+    return (T*)a->raw_resize((void*)ptr, old_count * sizeof(T), new_count * sizeof(T));
+}
+
+// every thread gets its own temp allocator, the static allocator is shared and safe to use concurrently
+extern thread_local Allocator* temp_allocator;
 extern Allocator* static_allocator;
 
 struct FixedBufferAllocator : public Allocator {
+    // What happens to an allocation that does not fit into the rest of the buffer
+    enum class FullPolicy : uint8_t {
+        // Start over from the beginning of the buffer. Older allocations that are still in use get overwritten
+        WRAP,
+        // Wrap, printing a warning into stderr
+        REPORT,
+        // Return nullptr
+        FAIL,
+        PANIC,
+    };
+
     void* raw_alloc(size_t size) override;
     void raw_dealloc(void* ptr, size_t size) override;
 
+    inline Marker mark() override {
+        return Marker{buffer, buffer_off};
+    }
+
+    inline void restore(Marker marker) override {
+        if (marker.region == buffer) buffer_off = marker.off;
+        else buffer_off = 0;
+    }
+
+    inline void free() {
+        if (buffer != nullptr) OK_DEALLOC_PAGE(buffer, buffer_size);
+        buffer = nullptr;
+        buffer_size = 0;
+        buffer_off = 0;
+        OK_ALLOCATOR_STAT(on_release());
+    }
+
     static constexpr size_t DEFAULT_PAGE_COUNT = 5;
 
     void* buffer;
     size_t buffer_size;
     size_t buffer_off;
+    FullPolicy on_full;
+    // how many times an allocation started over from the beginning of the buffer
+    size_t wrap_count;
 };
 
 static inline uintptr_t align_to(uintptr_t size, uintptr_t align) {
     return size + ((align - (size & (align - 1))) & (align - 1));
 }
 
-struct ArenaAllocator : public Allocator {
+static inline size_t round_up_pow2(size_t x) {
+    size_t result = 1;
+    while (result < x) result <<= 1;
+    return result;
+}
+
+// the result is undefined for 0
+static inline uint32_t count_leading_zeros(uint64_t x) {
+#if defined(__GNUC__)
+    return (uint32_t)__builtin_clzll(x);
+#elif defined(_MSC_VER)
+    unsigned long idx;
+    _BitScanReverse64(&idx, x);
+    return 63 - (uint32_t)idx;
+#else
+    uint32_t n = 0;
+    while (!(x & ((uint64_t)1 << 63))) { x <<= 1; n++; }
+    return n;
+#endif
+}
+
+// the result is undefined for 0
+static inline uint32_t count_trailing_zeros(uint64_t x) {
+#if defined(__GNUC__)
+    return (uint32_t)__builtin_ctzll(x);
+#elif defined(_MSC_VER)
+    unsigned long idx;
+    _BitScanForward64(&idx, x);
+    return (uint32_t)idx;
+#else
+    uint32_t n = 0;
+    while (!(x & 1)) { x >>= 1; n++; }
+    return n;
+#endif
+}
+
+static inline uint32_t count_ones(uint64_t x) {
+#if defined(__GNUC__)
+    return (uint32_t)__builtin_popcountll(x);
+#else
+    x = x - ((x >> 1) & 0x5555555555555555ull);
+    x = (x & 0x3333333333333333ull) + ((x >> 2) & 0x3333333333333333ull);
+    x = (x + (x >> 4)) & 0x0F0F0F0F0F0F0F0Full;
+    return (uint32_t)((x * 0x0101010101010101ull) >> 56);
+#endif
+}
+
+struct ArenaAllocator final : public Allocator {
     struct Region {
         size_t avail() const {
             OK_ASSERT(off <= size);
@@ -180,80 +516,342 @@ struct ArenaAllocator : public Allocator {
         size_t off;
     };
 
-    void* raw_alloc(size_t size) override;
-    void raw_dealloc(void* ptr, size_t size) override;
-    void* raw_resize(void* ptr, size_t old_size, size_t new_size) override;
+    static constexpr size_t DEFAULT_REGION_SIZE = OK_PAGE_SIZE * 4;
+    static constexpr size_t MAX_REGION_SIZE = (size_t)1 << 30;
+
+    // The bump paths live in the header so that callers holding an ArenaAllocator* can inline them
+    inline void* raw_alloc(size_t size) override {
+        OK_ALLOCATOR_STAT(on_alloc(size, align_to(size, sizeof(void*))));
+        size = align_to(size, sizeof(void*));
+
+        Region* region = current;
+
+        if (region == nullptr || region->size - region->off < size) {
+            region = next_region(size);
+        }
+
+        void* ptr = (void*)((uint8_t*)region->data + region->off);
+        region->off += size;
+        return ptr;
+    }
+
+    inline void raw_dealloc(void* ptr, size_t size) override {
+        if (current == nullptr) return;
+
+        OK_ALLOCATOR_STAT(on_dealloc(size));
+
+        size = align_to(size, sizeof(void*));
+        uint8_t* top = (uint8_t*)current->data + current->off;
+
+        if ((uint8_t*)ptr + size == top) current->off -= size;
+    }
+
+    inline void* raw_resize(void* old_ptr, size_t old_size, size_t new_size) override {
+        if (current != nullptr) {
+            uint8_t* data = (uint8_t*)current->data;
+            uint8_t* ptr = (uint8_t*)old_ptr;
+            size_t aligned_old_size = align_to(old_size, sizeof(void*));
+
+            // the block is the last allocation in the current region, so it can grow or shrink in place
+            if (ptr >= data && ptr + aligned_old_size == data + current->off) {
+                size_t start = ptr - data;
+                size_t aligned_new_size = align_to(new_size, sizeof(void*));
+
+                if (current->size - start >= aligned_new_size) {
+                    current->off = start + aligned_new_size;
+                    OK_ALLOCATOR_STAT(on_resize(old_size, new_size));
+                    return old_ptr;
+                }
+            }
+        }
+
+        auto* new_ptr = raw_alloc(new_size);
+        memcpy(new_ptr, old_ptr, old_size < new_size ? old_size : new_size);
+        // the old block stays in the arena, but it is no longer live
+        OK_ALLOCATOR_STAT(on_dealloc(old_size));
+        return new_ptr;
+    }
+
+    // Markers stay valid until the arena is reset or restored to an earlier marker
+    Marker mark() override;
+    void restore(Marker marker) override;
 
     Region* alloc_region(size_t size);
 
+    // Moves the cursor to a region that has at least `size` bytes available, installing a new one if needed
+    Region* next_region(size_t size);
+
+    // Regions before the cursor are considered full and regions after it are empty,
+    // so only the cursor and its successors can hand out memory
     inline size_t avail() const {
         size_t result = 0;
-        for (Region* r = head; r != nullptr; r = r->next) result += r->avail();
+        for (Region* r = current; r != nullptr; r = r->next) result += r->avail();
         return result;
     }
 
+    // Makes sure that the next allocation of up to `bytes` bytes will not need a new region
     inline void reserve(size_t bytes) {
-        size_t available_bytes = avail();
+        if (current != nullptr && current->avail() >= bytes) return;
+        next_region(bytes);
+    }
 
-        if (available_bytes < bytes) {
-            size_t bytes_needed = bytes - available_bytes;
-            Region* r = alloc_region(bytes_needed);
-            r->next = head;
-            head = r;
-        }
+    // Bytes handed out from the regions, including padding
+    inline size_t used() const {
+        size_t result = 0;
+        for (Region* r = head; r != nullptr; r = r->next) result += r->off;
+        return result;
+    }
+
+    inline size_t region_count() const {
+        size_t result = 0;
+        for (Region* r = head; r != nullptr; r = r->next) result++;
+        return result;
     }
 
     inline void reset() {
         for (Region* r = head; r != nullptr; r = r->next) r->off = 0;
+        current = head;
+        OK_ALLOCATOR_STAT(on_reset());
     }
 
     inline void free() {
-        for (Region* r = head; r != nullptr; r = r->next) OK_DEALLOC_PAGE(head->data, head->size);
+        for (Region* r = head; r != nullptr; r = r->next) OK_DEALLOC_PAGE(r->data, r->size);
+        head = nullptr;
+        current = nullptr;
+        OK_ALLOCATOR_STAT(on_release());
     }
 
     Region* head;
+    Region* current;
     Region* region_pool;
 };
 
+// An arena that can be allocated from by multiple threads at once. Regions are bump-allocated
+// with a CAS on their offset and new regions are installed by swapping the head pointer,
+// so no locks are taken. Only the newest region is allocated from.
+struct ConcurrentArenaAllocator final : public Allocator {
+    struct Region {
+        inline uint8_t* data() {
+            return (uint8_t*)this + HEADER_SIZE;
+        }
+
+        Region* next;
+        size_t size;
+        std::atomic<size_t> off;
+    };
+
+    static constexpr size_t HEADER_SIZE = (sizeof(Region) + sizeof(void*) - 1) & ~(sizeof(void*) - 1);
+    static constexpr size_t DEFAULT_REGION_SIZE = OK_PAGE_SIZE * 16;
+    static constexpr size_t MAX_REGION_SIZE = (size_t)1 << 30;
+
+    void* raw_alloc(size_t size) override;
+    void raw_dealloc(void* ptr, size_t size) override;
+    void* raw_resize(void* ptr, size_t old_size, size_t new_size) override;
+
+    // The following methods must not race with allocations
+    Marker mark() override;
+    void restore(Marker marker) override;
+
+    // Keeps the newest region and returns the others to the OS
+    void reset();
+    void free();
+
+    std::atomic<Region*> head;
+};
+
+// Hands out blocks from power-of-two size classes, keeping freed blocks in per-class free lists.
+// Blocks carry no header, so deallocations must pass the same size that was used to allocate them.
+// Allocations bigger than MAX_BLOCK_SIZE are mapped straight from the OS.
+struct PoolAllocator final : public Allocator {
+    struct Block {
+        Block* next;
+    };
+
+    struct Chunk {
+        Chunk* next;
+        size_t size;
+    };
+
+    static constexpr size_t MIN_BLOCK_SHIFT = 4;
+    static constexpr size_t MIN_BLOCK_SIZE = (size_t)1 << MIN_BLOCK_SHIFT;
+    static constexpr size_t SIZE_CLASS_COUNT = 9;
+    static constexpr size_t MAX_BLOCK_SIZE = MIN_BLOCK_SIZE << (SIZE_CLASS_COUNT - 1);
+    static constexpr size_t CHUNK_SIZE = OK_PAGE_SIZE * 16;
+
+    static inline size_t size_class(size_t size) {
+        if (size <= MIN_BLOCK_SIZE) return 0;
+        return 64 - count_leading_zeros(size - 1) - MIN_BLOCK_SHIFT;
+    }
+
+    static inline size_t block_size(size_t size_class) {
+        return MIN_BLOCK_SIZE << size_class;
+    }
+
+    void* raw_alloc(size_t size) override;
+    void raw_dealloc(void* ptr, size_t size) override;
+    void* raw_resize(void* ptr, size_t old_size, size_t new_size) override;
+
+    // Carves a new chunk into blocks of the given class and pushes them onto its free list
+    void refill(size_t size_class);
+
+    // Returns every chunk to the OS. Large allocations are not tracked and must be deallocated separately.
+    void free();
+
+    Block* free_lists[SIZE_CLASS_COUNT];
+    Chunk* chunks;
+};
+
+// Forwards every call to another allocator. With OK_ALLOCATOR_TRACING enabled the calls are
+// recorded into a ring that keeps the most recent events, otherwise it only forwards
+struct TracingAllocator : public Allocator {
+    enum class EventKind : uint8_t {
+        ALLOC,
+        DEALLOC,
+        RESIZE,
+    };
+
+    struct Event {
+        // set for calls made through OK_TRACE_SITE, nullptr otherwise
+        const char* file;
+        // return address of the traced call
+        void* caller;
+        void* ptr;
+        size_t size;
+        size_t old_size;
+        uint32_t line;
+        EventKind kind;
+    };
+
+    static constexpr size_t DEFAULT_EVENT_CAPACITY = 256;
+
+    // The ring is allocated from the parent and rounded up to a power of two
+    static void init(TracingAllocator* out, Allocator* parent, size_t event_capacity = DEFAULT_EVENT_CAPACITY);
+
+    void* raw_alloc(size_t size) override;
+    void raw_dealloc(void* ptr, size_t size) override;
+    void* raw_resize(void* ptr, size_t old_size, size_t new_size) override;
+
+    inline Marker mark() override {
+        return parent->mark();
+    }
+
+    inline void restore(Marker marker) override {
+        parent->restore(marker);
+    }
+
+    // Attributes the next call to the given source location
+    inline TracingAllocator* at(const char* file, uint32_t line) {
+        site_file = file;
+        site_line = line;
+        return this;
+    }
+
+    // How many of the recorded events are still in the ring
+    inline size_t retained() const {
+        return event_count < event_capacity ? event_count : event_capacity;
+    }
+
+    // Retained events, oldest first
+    inline const Event& event(size_t idx) const {
+        OK_ASSERT(idx < retained());
+        return events[(event_count - retained() + idx) & (event_capacity - 1)];
+    }
+
+    void record(EventKind kind, void* caller, void* ptr, size_t size, size_t old_size);
+
+    // Prints the retained events into stderr
+    void report() const;
+
+    void free();
+
+    Allocator* parent;
+    Event* events;
+    size_t event_capacity;
+    // every event that was recorded, including the ones that were overwritten
+    size_t event_count;
+    const char* site_file;
+    uint32_t site_line;
+};
+
+#define OK_TRACE_SITE(tracer) ((tracer)->at(__FILE__, __LINE__))
+
 // templates
 #define OK_LIST_GROW_FACTOR(x) ((((x) + 1) * 3) >> 1)
 
 template <typename T>
 struct Slice;
 
+// The default ordering for sorting and searching
+struct Less {
+    template <typename A, typename B>
+    inline bool operator ()(const A& a, const B& b) const {
+        return a < b;
+    }
+};
+
+// Types whose values can be moved to another address with memcpy, leaving the old bytes behind.
+// Specialize it for types that are not trivially copyable but do not care where they live
 template <typename T>
+struct IsTriviallyRelocatable : std::is_trivially_copyable<T> {};
+
+// Lists construct and destroy their items in place, so they can hold non-trivial types.
+// Buffers of trivially relocatable types still grow through Allocator::resize.
+// `A` can name a concrete final allocator, e.g. List<T, ArenaAllocator>, which binds the
+// allocation calls statically so the bump path inlines into push
+template <typename T, typename A = Allocator>
 struct List {
-    static List<T> alloc(Allocator* a, size_t cap = List::DEFAULT_CAP);
+    static List<T, A> alloc(A* a, size_t cap = List::DEFAULT_CAP);
 
     static constexpr size_t DEFAULT_CAP = 7;
 
     void push(const T& item);
-    void extend(List<T> other);
+    void push(T&& item);
+
+    // Constructs an item at the end of the list from `args`
+    template <typename... Args>
+    T& emplace(Args&&... args);
+
+    // Appends `n` items at once, growing the list at most one time
+    void append_many(const T* source, size_t n);
+    void extend(Slice<T> other);
+    void extend(List<T, A> other);
     void remove_at(size_t idx);
 
-    List<T> copy(Allocator* a, size_t start, size_t end) const;
+    List<T, A> copy(A* a, size_t start, size_t end) const;
 
-    inline List<T> copy(Allocator* a, size_t start) const {
+    inline List<T, A> copy(A* a, size_t start) const {
         return copy(a, start, count);
     }
 
-    inline List<T> copy(Allocator* a) const {
+    inline List<T, A> copy(A* a) const {
         return copy(a, 0, count);
     }
 
     void reserve(size_t new_cap);
 
+    // Destroys the items, keeping the buffer
+    void clear();
+    // Destroys the items and gives the buffer back to the allocator
+    void free();
+
     size_t find_index(const T& elem);
     template <typename F>
     size_t find_index(F pred);
 
+    // See the free functions of the same names
+    template <typename Compare = Less>
+    void sort(Compare less = Compare{});
+    template <typename Compare = Less>
+    void stable_sort(Allocator* scratch, Compare less = Compare{});
+    void radix_sort(Allocator* scratch);
+
     Slice<T> slice(size_t start, size_t end) const;
     Slice<T> slice(size_t start) const;
     Slice<T> slice() const;
 
     template <typename Dest>
-    inline List<Dest> cast() {
-        List<Dest> list;
+    inline List<Dest, A> cast() {
+        List<Dest, A> list;
         list.allocator = allocator;
         list.items = (Dest*)items;
         list.count = count;
@@ -276,7 +874,7 @@ struct List {
     T* items;
     size_t count;
     size_t capacity;
-    Allocator* allocator;
+    A* allocator;
 };
 
 template <typename T>
@@ -304,16 +902,76 @@ struct Slice {
         return items[idx];
     }
 
+    // The searches expect the slice to be sorted by `less`
+
+    // Index of the first item that is not less than `value`, `count` if there is none
+    template <typename Q, typename Compare = Less>
+    inline size_t lower_bound(const Q& value, Compare less = Compare{}) const {
+        if (count == 0) return 0;
+
+        // the halving happens without branching on the comparison
+        const T* base = items;
+        size_t n = count;
+
+        while (n > 1) {
+            size_t half = n / 2;
+            base = less(base[half], value) ? base + half : base;
+            n -= half;
+        }
+
+        return (size_t)(base - items) + less(*base, value);
+    }
+
+    // Index of the first item that is greater than `value`, `count` if there is none
+    template <typename Q, typename Compare = Less>
+    inline size_t upper_bound(const Q& value, Compare less = Compare{}) const {
+        if (count == 0) return 0;
+
+        const T* base = items;
+        size_t n = count;
+
+        while (n > 1) {
+            size_t half = n / 2;
+            base = !less(value, base[half]) ? base + half : base;
+            n -= half;
+        }
+
+        return (size_t)(base - items) + !less(value, *base);
+    }
+
+    template <typename Q, typename Compare = Less>
+    inline bool binary_search(const Q& value, Compare less = Compare{}) const {
+        size_t idx = lower_bound(value, less);
+        return idx < count && !less(value, items[idx]);
+    }
+
     const T* items;
     size_t count;
 };
 
+// sorting
+// Unstable in-place sort, pattern-defeating quicksort with a heapsort fallback
+template <typename T, typename Compare = Less>
+void sort(T* items, size_t count, Compare less = Compare{});
+
+// Stable merge sort, takes up to count / 2 items of scratch space from `scratch`
+template <typename T, typename Compare = Less>
+void stable_sort(T* items, size_t count, Allocator* scratch, Compare less = Compare{});
+
+// Stable LSD radix sort on an integer key, takes `count` items of scratch space from `scratch`
+template <typename T, typename Key>
+void radix_sort(T* items, size_t count, Allocator* scratch, Key key);
+
+template <typename T>
+void radix_sort(T* items, size_t count, Allocator* scratch);
+
 // char predicates
 bool is_whitespace(char);
 bool is_digit(char);
 bool is_alpha(char);
 
 struct String;
+struct StringSplit;
 
 #define OK_SV_FMT "%.*s"
 #define OK_SV_ARG(sv) (int)(sv).count, reinterpret_cast<const char*>((sv).data)
@@ -335,20 +993,53 @@ struct StringView {
         return view(start, count);
     }
 
-    inline bool operator ==(const StringView rhs) const {
-        if (count != rhs.count) return false;
+    static constexpr size_t NPOS = (size_t)-1;
 
-        for (size_t i = 0; i < count; i++) {
-            if (data[i] != rhs.data[i]) return false;
-        }
+    // The searches return the index of the first match at or after `start`, or NPOS
+    size_t find(char c, size_t start = 0) const;
+    size_t find(StringView needle, size_t start = 0) const;
+    size_t find_any_of(StringView chars, size_t start = 0) const;
 
-        return true;
+    // Number of occurrences of `c`, named so because `count` is the length
+    size_t count_of(char c) const;
+
+    inline bool contains(char c) const {
+        return find(c) != NPOS;
+    }
+
+    inline bool contains(StringView needle) const {
+        return find(needle) != NPOS;
+    }
+
+    inline bool starts_with(StringView prefix) const {
+        return count >= prefix.count && (prefix.count == 0 || memcmp(data, prefix.data, prefix.count) == 0);
+    }
+
+    inline bool ends_with(StringView suffix) const {
+        return count >= suffix.count
+            && (suffix.count == 0 || memcmp(data + count - suffix.count, suffix.data, suffix.count) == 0);
+    }
+
+    // Lazily splits on every occurrence of the delimiter, empty fields included
+    StringSplit split(char delimiter) const;
+    StringSplit split(StringView delimiter) const;
+
+    inline bool operator ==(const StringView rhs) const {
+        if (count != rhs.count) return false;
+        return count == 0 || memcmp(data, rhs.data, count) == 0;
     }
 
     inline bool operator!=(const StringView & string_view) const {
         return !(*this == string_view);
     }
 
+    // Bytewise lexicographic order
+    inline bool operator <(const StringView rhs) const {
+        size_t n = count < rhs.count ? count : rhs.count;
+        int cmp = n == 0 ? 0 : memcmp(data, rhs.data, n);
+        return cmp < 0 || (cmp == 0 && count < rhs.count);
+    }
+
     bool operator ==(const String& string) const;
 
     inline bool operator!=(const String& string) const {
@@ -364,6 +1055,44 @@ struct StringView {
     size_t count;
 };
 
+struct StringSplit {
+    // Stores the next field in `out`, returns false once every field has been produced
+    inline bool next(StringView* out) {
+        if (finished) return false;
+
+        size_t idx = delimiter.count == 0 ? rest.find(delimiter_char) : rest.find(delimiter);
+        size_t delimiter_count = delimiter.count == 0 ? 1 : delimiter.count;
+
+        if (idx == StringView::NPOS) {
+            *out = rest;
+            finished = true;
+            return true;
+        }
+
+        *out = rest.view(0, idx);
+        rest = rest.view(idx + delimiter_count);
+        return true;
+    }
+
+    StringView rest;
+    // an empty delimiter means that the single `delimiter_char` is split on
+    StringView delimiter;
+    char delimiter_char;
+    bool finished;
+};
+
+// MSD radix sort, takes `count` views of scratch space from `scratch`
+void radix_sort(StringView* items, size_t count, Allocator* scratch);
+
+inline StringSplit StringView::split(char delimiter) const {
+    return StringSplit{*this, StringView{nullptr, 0}, delimiter, false};
+}
+
+inline StringSplit StringView::split(StringView delimiter) const {
+    OK_ASSERT(delimiter.count > 0);
+    return StringSplit{*this, delimiter, '\0', false};
+}
+
 inline namespace literals {
 constexpr StringView operator ""_sv(const char* cstr, size_t len) {
     return StringView{cstr, len};
@@ -374,6 +1103,21 @@ struct String {
     static constexpr char NULL_CHAR = '\0';
     static constexpr size_t DEFAULT_CAPACITY = 7;
 
+    struct Heap {
+        char* items;
+        size_t count;
+        uint32_t capacity_lo;
+        uint16_t capacity_hi;
+        uint8_t _unused;
+        uint8_t tag;
+    };
+
+    // Strings of up to INLINE_CAPACITY chars live inside the struct itself. The last byte holds
+    // their count, or HEAP_TAG once they have spilled to the allocator, so a zeroed String is empty
+    static constexpr size_t TAG_INDEX = sizeof(Heap) - 1;
+    static constexpr size_t INLINE_CAPACITY = sizeof(Heap) - 2;
+    static constexpr uint8_t HEAP_TAG = 0x80;
+
     static String alloc(Allocator* a, size_t capacity = DEFAULT_CAPACITY);
 
     static String alloc(Allocator* a, const char* data, size_t data_len);
@@ -385,21 +1129,42 @@ struct String {
     static String format(Allocator* a, const char* fmt, ...) ATTRIBUTE_PRINTF(2, 3);
 
     void append(StringView);
-    void append(String);
+    void append(const String&);
 
     void format_append(const char*, ...) ATTRIBUTE_PRINTF(2, 3);
 
+    // Formats numbers straight into the string, without going through a temporary
+    void append_int(int64_t value);
+    void append_uint(uint64_t value);
+    void append_double(double value);
+
     bool starts_with(StringView);
 
+    // Makes room for at least `chars` chars, moving the contents to the allocator if they no longer fit in place
+    void reserve(size_t chars);
+    void free();
+
+    inline bool is_inline() const {
+        return (uint8_t)small[TAG_INDEX] != HEAP_TAG;
+    }
+
     inline const char* cstr() const {
-        return reinterpret_cast<const char*>(data.items);
+        return is_inline() ? small : heap.items;
+    }
+
+    inline char* data() {
+        return is_inline() ? small : heap.items;
+    }
+
+    inline const char* data() const {
+        return cstr();
     }
 
     inline StringView view(size_t start, size_t end) const {
-        OK_ASSERT(start < count());
+        OK_ASSERT(start <= count());
         OK_ASSERT(end >= start);
 
-        return StringView{data.items + start, end - start};
+        return StringView{cstr() + start, end - start};
     }
 
     inline StringView view(size_t start) const {
@@ -410,28 +1175,42 @@ struct String {
         return view(0, count());
     }
 
-    inline String copy(Allocator* a) {
-        String s;
-        s.data = data.copy(a);
+    inline String copy(Allocator* a) const {
+        size_t n = count();
+
+        String s = String::alloc(a, n);
+        memcpy(s.data(), cstr(), n);
+        s.set_count(n);
+
         return s;
     }
 
     inline void push(char character) {
-        data.push(NULL_CHAR);
-        data[data.count - 2] = character;
-    }
-
-    inline void reserve(size_t chars) {
-        size_t available_size = count();
+        size_t n = count();
+        if (n == capacity()) reserve(n < INLINE_CAPACITY ? INLINE_CAPACITY : n * 2);
 
-        if (available_size >= chars) return;
+        data()[n] = character;
+        set_count(n + 1);
+    }
 
-        data.reserve(chars + 1);
+    // Number of chars the string can hold without reallocating, the null terminator is not included
+    inline size_t capacity() const {
+        if (is_inline()) return INLINE_CAPACITY;
+        return (size_t)((uint64_t)heap.capacity_lo | ((uint64_t)heap.capacity_hi << 32)) - 1;
     }
 
     inline size_t count() const {
-        OK_ASSERT(data.count != 0);
-        return data.count - 1;
+        return is_inline() ? (size_t)(uint8_t)small[TAG_INDEX] : heap.count;
+    }
+
+    // Sets the count of chars that have been written into `data()` and terminates them
+    inline void set_count(size_t n) {
+        OK_ASSERT(n <= capacity());
+
+        data()[n] = NULL_CHAR;
+
+        if (is_inline()) small[TAG_INDEX] = (char)n;
+        else heap.count = n;
     }
 
     inline bool operator ==(const String& other) const {
@@ -450,21 +1229,31 @@ struct String {
         return !(*this == other);
     }
 
+    inline bool operator <(const String& other) const {
+        return view() < other.view();
+    }
+
     inline char& operator [](size_t idx) {
         OK_ASSERT(idx < count());
 
-        return data.items[idx];
+        return data()[idx];
     }
 
     inline const char& operator [](size_t idx) const {
         OK_ASSERT(idx < count());
 
-        return data.items[idx];
+        return cstr()[idx];
     }
 
-    List<char> data;
+    union {
+        Heap heap;
+        char small[sizeof(Heap)];
+    };
+    Allocator* allocator;
 };
 
+static_assert(offsetof(String::Heap, tag) == String::TAG_INDEX, "the tag has to be the last byte of a String");
+
 template <template <typename> class Self, typename T>
 struct OptionalBase {
     const T& or_else(const T& other) const {
@@ -492,7 +1281,9 @@ struct OptionalBase {
 
 template <typename T>
 struct Optional : public OptionalBase<Optional, T> {
-    Optional() : _has_value{false} {}
+    Optional() : _has_value{false} {
+        _clear_value(std::is_trivial<T>{});
+    }
 
     Optional(T value) : _has_value{true}, value{value} {}
 
@@ -519,6 +1310,14 @@ struct Optional : public OptionalBase<Optional, T> {
     }
 
 
+    // An empty Optional of a trivial type still gets copied around whole, zeroing the payload
+    // keeps GCC from flagging those copies as maybe-uninitialized once they are inlined
+    inline void _clear_value(std::true_type) {
+        memset((void*)&value, 0, sizeof(value));
+    }
+
+    inline void _clear_value(std::false_type) {}
+
     bool _has_value;
     T value;
 
@@ -561,6 +1360,75 @@ struct Optional<T*> : public OptionalBase<Optional, T> {
 
 static_assert(sizeof(Optional<int*>) == sizeof(int*));
 
+// Reserves one large range of address space up front and commits it as the bump pointer
+// advances, so everything it hands out is contiguous and the last allocation can always grow in
+// place. A zero-initialized arena reserves DEFAULT_RESERVE_SIZE on its first allocation
+struct VirtualArenaAllocator final : public Allocator {
+    enum class Error {
+        RESERVE_FAILED,
+    };
+
+    // address space is cheap, so the default leaves room for just about anything
+    static constexpr size_t DEFAULT_RESERVE_SIZE = sizeof(void*) == 8 ? (size_t)64 << 30 : (size_t)512 << 20;
+    static constexpr size_t COMMIT_GRANULARITY = OK_PAGE_SIZE * 16;
+    static constexpr size_t HUGE_PAGE_SIZE = (size_t)2 << 20;
+
+    // With `huge_pages` the range is aligned to HUGE_PAGE_SIZE and committed in huge page steps,
+    // asking the kernel to back it with transparent huge pages. Windows only hands out large pages
+    // to privileged processes and not on demand, so it is ignored there
+    static Optional<Error> init(VirtualArenaAllocator* out, size_t reserve_size = DEFAULT_RESERVE_SIZE,
+                                bool huge_pages = false);
+
+    // Allocations that fit into the committed pages only move the bump pointer
+    inline void* raw_alloc(size_t size) override {
+        size_t aligned = align_to(size, sizeof(void*));
+        if (base == nullptr || aligned > committed - off) return commit_and_alloc(size);
+
+        void* ptr = base + off;
+        off += aligned;
+
+        OK_ALLOCATOR_STAT(on_alloc(size, aligned));
+        return ptr;
+    }
+
+    // Reserves the range on first use and commits enough of it for the allocation
+    void* commit_and_alloc(size_t size);
+    void raw_dealloc(void* ptr, size_t size) override;
+    void* raw_resize(void* ptr, size_t old_size, size_t new_size) override;
+
+    inline Marker mark() override {
+        return Marker{base, off};
+    }
+
+    inline void restore(Marker marker) override {
+        off = marker.off;
+    }
+
+    // Makes sure that the first `size` bytes of the range are committed, false if they are not reserved
+    bool commit(size_t size);
+
+    // Keeps the committed pages around for reuse
+    inline void reset() {
+        off = 0;
+        OK_ALLOCATOR_STAT(on_reset());
+    }
+
+    // Returns the committed pages past the bump pointer to the OS, keeping the reservation
+    void decommit();
+    void free();
+
+    uint8_t* base;
+    size_t reserved;
+    size_t committed;
+    size_t off;
+    // what commits are rounded up to
+    size_t granularity;
+    // the reservation was made with extra room for aligning `base`, this is what gets unmapped
+    void* mapping;
+    size_t mapping_size;
+    bool huge_pages;
+};
+
 template <typename A, typename B> 
 struct Pair {
     A a;
@@ -568,7 +1436,45 @@ struct Pair {
 };
 
 namespace hash {
+// Mixed into the default hashes. Setting it to a random value before any tables are filled
+// makes collisions hard to provoke from the outside.
+extern uint64_t default_seed;
+
 uint64_t fnv1(StringView);
+
+// wyhash (final4 construction), reads the input 8 or 16 bytes at a time
+uint64_t wyhash(StringView, uint64_t seed);
+
+// Full 64x64 -> 128 bit multiplication, the low half ends up in `a` and the high half in `b`
+static inline void mum(uint64_t* a, uint64_t* b) {
+#if defined(__SIZEOF_INT128__)
+    __extension__ typedef unsigned __int128 uint128;
+    uint128 r = (uint128)*a * *b;
+    *a = (uint64_t)r;
+    *b = (uint64_t)(r >> 64);
+#elif defined(_MSC_VER) && defined(_M_X64)
+    *a = _umul128(*a, *b, b);
+#else
+    uint64_t ha = *a >> 32, hb = *b >> 32, la = (uint32_t)*a, lb = (uint32_t)*b;
+    uint64_t rh = ha * hb, rm0 = ha * lb, rm1 = hb * la, rl = la * lb;
+    uint64_t t = rl + (rm0 << 32);
+    uint64_t c = t < rl;
+    uint64_t lo = t + (rm1 << 32);
+    c += lo < t;
+    *a = lo;
+    *b = rh + (rm0 >> 32) + (rm1 >> 32) + c;
+#endif
+}
+
+static inline uint64_t mum_mix(uint64_t a, uint64_t b) {
+    mum(&a, &b);
+    return a ^ b;
+}
+
+// Scrambles an integer so that every bit of the input affects both halves of the result
+static inline uint64_t mix(uint64_t value, uint64_t seed) {
+    return mum_mix(value ^ 0x2d358dccaa6c78a5ull, seed ^ 0x8bb84b93962eacc9ull);
+}
 };
 
 template <typename T>
@@ -592,904 +1498,6201 @@ struct Hash<HashPtr<T>> {
 template <>
 struct Hash<uint32_t> {
     static uint64_t hash(const uint32_t& val) {
-        return val;
+        return ::ok::hash::mix(val, ::ok::hash::default_seed);
+    }
+};
+
+template <>
+struct Hash<int32_t> {
+    static uint64_t hash(const int32_t& val) {
+        return ::ok::hash::mix((uint32_t)val, ::ok::hash::default_seed);
     }
 };
 
 template <>
 struct Hash<size_t> {
     static uint64_t hash(const size_t& val) {
-        return val;
+        return ::ok::hash::mix(val, ::ok::hash::default_seed);
+    }
+};
+
+template <>
+struct Hash<int64_t> {
+    static uint64_t hash(const int64_t& val) {
+        return ::ok::hash::mix((uint64_t)val, ::ok::hash::default_seed);
     }
 };
 
 template <>
 struct Hash<StringView> {
     static uint64_t hash(StringView sv) {
-        return ::ok::hash::fnv1(sv);
+        return ::ok::hash::wyhash(sv, ::ok::hash::default_seed);
     }
 };
 
 template <>
 struct Hash<String> {
-    static uint64_t hash(String string) {
-        return ::ok::hash::fnv1(string.view());
+    static uint64_t hash(const String& string) {
+        return ::ok::hash::wyhash(string.view(), ::ok::hash::default_seed);
     }
 };
 
 template <typename T>
 bool operator ==(const HashPtr<T>& lhs, const HashPtr<T>& rhs);
 
-#define OK_TAB_META_OCCUPIED 0x01
-#define OK_TAB_IS_OCCUPIED(meta) ((meta) & OK_TAB_META_OCCUPIED)
+// Control bytes: the high bit marks a free slot, occupied slots store the 7 low bits of the key's hash
+#define OK_TAB_META_EMPTY ((uint8_t)0x80)
+#define OK_TAB_META_DELETED ((uint8_t)0xFE)
+#define OK_TAB_IS_OCCUPIED(meta) (((meta) & 0x80) == 0)
 #define OK_TAB_IS_FREE(meta) (!OK_TAB_IS_OCCUPIED((meta)))
 
-#define OK_TABLE_GROWTH_FACTOR(x) (((x) + 1) * 3)
+#define OK_TAB_H1(hash) ((hash) >> 7)
+#define OK_TAB_H2(hash) ((uint8_t)((hash) & 0x7F))
 
-#define OK_TABLE_FOREACH(tab, key, value, code) do { \
-    for (size_t _tab_i = 0; _tab_i < (tab).capacity; _tab_i++) {\
-    if (OK_TAB_IS_FREE((tab).meta[_tab_i])) continue; \
-    auto key = (tab).keys[_tab_i]; \
-    auto value = (tab).values[_tab_i]; \
-    code; \
-    }\
-    } while (0)
+#define OK_TABLE_GROWTH_FACTOR(x) ((x) * 2)
 
-template <typename K, typename V>
-struct Table {
-    using Meta = uint8_t;
+// Binds references into the table, the values are const when the table is. They dangle as soon as
+// `code` puts into or removes from the table, so collect the changes and apply them afterwards
+#define OK_TABLE_FOREACH(tab, _key_name, _value_name, code) do { \
+    auto _tab_it = (tab).iter(); \
+    for (typename decltype(_tab_it)::Entry _tab_entry; _tab_it.next(&_tab_entry);) { \
+        const auto& _key_name = *_tab_entry.key; \
+        auto& _value_name = *_tab_entry.value; \
+        code; \
+    } \
+} while (0)
 
-    static Table<K, V> alloc(Allocator* a, size_t capacity = Table::DEFAULT_CAPACITY);
+// A group of control bytes that is matched against all at once
+struct TableGroup {
+    static constexpr size_t WIDTH = 16;
 
-    void put(const K& key, const V& value);
-    Optional<V> get(const K& key);
-    bool has(const K& key);
+    // A set of slots in the group, iterated from the lowest one
+    struct Mask {
+#if OK_NEON
+        static constexpr uint32_t SHIFT = 2;
+#else
+        static constexpr uint32_t SHIFT = 0;
+#endif // OK_NEON
 
-    static constexpr size_t DEFAULT_CAPACITY = 47;
+        inline bool any() const {
+            return bits != 0;
+        }
 
-    inline uint8_t load_percentage() const {
-        return (uint8_t)((double)(count * 100) / (double)capacity);
-    }
+        inline size_t lowest() const {
+            return count_trailing_zeros(bits) >> SHIFT;
+        }
 
-    K* keys;
-    V* values;
-    uint8_t* meta;
-    size_t count;
-    size_t capacity;
-    Allocator* allocator;
-};
+        inline void clear_lowest() {
+            bits &= bits - 1;
+        }
 
-#define OK_SET_GROWTH_FACTOR OK_TABLE_GROWTH_FACTOR
+        uint64_t bits;
+    };
 
-template <typename T>
-struct Set {
-    using Meta = uint8_t;
+#if OK_SSE2
+    explicit TableGroup(const uint8_t* meta) : ctrl{_mm_loadu_si128((const __m128i*)meta)} {}
 
-    static constexpr size_t DEFAULT_CAPACITY = 47;
+    inline Mask match(uint8_t h2) const {
+        return Mask{(uint32_t)_mm_movemask_epi8(_mm_cmpeq_epi8(_mm_set1_epi8((char)h2), ctrl))};
+    }
 
-    static Set<T> alloc(Allocator* a, size_t capacity = DEFAULT_CAPACITY);
+    inline Mask match_empty() const {
+        return match(OK_TAB_META_EMPTY);
+    }
 
-    void put(const T& elem);
-    bool has(const T& elem) const;
+    inline Mask match_free() const {
+        return Mask{(uint32_t)_mm_movemask_epi8(ctrl)};
+    }
 
-    inline uint8_t load_percentage() const {
-        return (uint8_t)(100.0 * (double)count / (double)capacity);
+    inline Mask match_full() const {
+        return Mask{~(uint32_t)_mm_movemask_epi8(ctrl) & 0xFFFF};
     }
 
-    Allocator* allocator;
-    size_t capacity;
-    size_t count;
-    T* values;
-    uint8_t* meta;
-};
+    __m128i ctrl;
+#elif OK_NEON
+    explicit TableGroup(const uint8_t* meta) : ctrl{vld1q_u8(meta)} {}
 
-// HASH IMPLEMENTATION
-template <typename T>
-bool operator ==(const HashPtr<T>& lhs, const HashPtr<T>& rhs) {
-    return *lhs.value == *rhs.value;
-}
+    static inline Mask to_mask(uint8x16_t cmp) {
+        uint8x8_t nibbles = vshrn_n_u16(vreinterpretq_u16_u8(cmp), 4);
+        return Mask{vget_lane_u64(vreinterpret_u64_u8(nibbles), 0) & 0x8888888888888888ull};
+    }
 
-// OPTIONAL IMPLEMENTATION
-template <typename T>
-const Optional<T> Optional<T>::NONE = Optional<T>{};
+    inline Mask match(uint8_t h2) const {
+        return to_mask(vceqq_u8(ctrl, vdupq_n_u8(h2)));
+    }
 
-template <typename T>
-const Optional<T> Optional<T*>::NONE = Optional<T*>{};
+    inline Mask match_empty() const {
+        return match(OK_TAB_META_EMPTY);
+    }
 
-// LIST IMPLEMENTATION
-template <typename T>
-List<T> List<T>::alloc(Allocator* a, size_t cap) {
-    List<T> list{};
-    list.items = a->alloc<T>(cap);
-    list.count = 0;
-    list.capacity = cap;
-    list.allocator = a;
+    inline Mask match_free() const {
+        return to_mask(vtstq_u8(ctrl, vdupq_n_u8(0x80)));
+    }
 
-    return list;
-}
+    inline Mask match_full() const {
+        return Mask{~match_free().bits & 0x8888888888888888ull};
+    }
 
-template <typename T>
-void List<T>::push(const T& item) {
-    if (count >= capacity) {
-        size_t new_capacity = OK_LIST_GROW_FACTOR(capacity);
-        items = allocator->resize<T>(items, capacity, new_capacity);
-        capacity = new_capacity;
+    uint8x16_t ctrl;
+#else
+    explicit TableGroup(const uint8_t* meta) {
+        memcpy(ctrl, meta, WIDTH);
     }
 
-    items[count++] = item;
-}
+    inline Mask match(uint8_t h2) const {
+        uint64_t bits = 0;
+        for (size_t i = 0; i < WIDTH; i++) bits |= (uint64_t)(ctrl[i] == h2) << i;
+        return Mask{bits};
+    }
 
-template <typename T>
-inline void List<T>::remove_at(size_t idx) {
-    OK_ASSERT(idx < count);
+    inline Mask match_empty() const {
+        return match(OK_TAB_META_EMPTY);
+    }
 
-    for (size_t i = idx; i < count - 1; i++) {
-        items[i] = items[i + 1];
+    inline Mask match_free() const {
+        uint64_t bits = 0;
+        for (size_t i = 0; i < WIDTH; i++) bits |= (uint64_t)OK_TAB_IS_FREE(ctrl[i]) << i;
+        return Mask{bits};
     }
 
-    count--;
-}
+    inline Mask match_full() const {
+        return Mask{~match_free().bits & 0xFFFF};
+    }
 
-template <typename T>
-inline List<T> List<T>::copy(Allocator* a, size_t start, size_t end) const {
-    OK_ASSERT(end >= start);
+    uint8_t ctrl[WIDTH];
+#endif // OK_SSE2
+};
 
-    auto res = List<T>::alloc(a, end - start);
-    for (size_t i = start; i < end; i++) {
-        res.push(items[i]);
-    }
-    return res;
-}
+// A block of bytes compared against a character all at once, used by the StringView searches.
+// Matches come back as a TableGroup::Mask, which has the same layout on every backend.
+struct ByteBlock {
+    using Mask = TableGroup::Mask;
 
-template <typename T>
-inline void List<T>::extend(List<T> other) {
-    reserve(capacity + other.capacity);
+#if OK_AVX2
+    static constexpr size_t WIDTH = 32;
 
-    for (size_t i = 0; i < other.count; i++) {
-        push(other.items[i]);
+    explicit ByteBlock(const char* data) : bytes{_mm256_loadu_si256((const __m256i*)data)} {}
+
+    inline Mask match(char c) const {
+        return Mask{(uint32_t)_mm256_movemask_epi8(_mm256_cmpeq_epi8(_mm256_set1_epi8(c), bytes))};
     }
-}
 
-template <typename T>
-inline void List<T>::reserve(size_t new_cap) {
-    if (new_cap <= capacity) {
-        return;
+    __m256i bytes;
+#elif OK_SSE2
+    static constexpr size_t WIDTH = 16;
+
+    explicit ByteBlock(const char* data) : bytes{_mm_loadu_si128((const __m128i*)data)} {}
+
+    inline Mask match(char c) const {
+        return Mask{(uint32_t)_mm_movemask_epi8(_mm_cmpeq_epi8(_mm_set1_epi8(c), bytes))};
     }
 
-    items = allocator->resize<T>(items, capacity, new_cap);
-    capacity = new_cap;
-}
+    __m128i bytes;
+#elif OK_NEON
+    static constexpr size_t WIDTH = 16;
 
-template <typename T>
-inline size_t List<T>::find_index(const T& elem) {
-    for (size_t i = 0; i < count; i++) {
-        if (items[i] == elem) {
-            return i;
-        }
+    explicit ByteBlock(const char* data) : bytes{vld1q_u8((const uint8_t*)data)} {}
+
+    inline Mask match(char c) const {
+        return TableGroup::to_mask(vceqq_u8(bytes, vdupq_n_u8((uint8_t)c)));
     }
 
-    return (size_t)-1;
-}
+    uint8x16_t bytes;
+#else
+    static constexpr size_t WIDTH = 16;
 
-template <typename T>
-template <typename F>
-inline size_t List<T>::find_index(F pred) {
-    for (size_t i = 0; i < count; i++) {
-        if (pred(items[i])) {
-            return i;
-        }
+    explicit ByteBlock(const char* data) {
+        memcpy(bytes, data, WIDTH);
     }
 
-    return (size_t)-1;
-}
+    inline Mask match(char c) const {
+        uint64_t bits = 0;
+        for (size_t i = 0; i < WIDTH; i++) bits |= (uint64_t)(bytes[i] == c) << i;
+        return Mask{bits};
+    }
 
-template <typename T>
-Slice<T> List<T>::slice(size_t start, size_t end) const {
-    OK_ASSERT(end >= start);
-    return Slice<T>{items + start, end - start};
+    char bytes[WIDTH];
+#endif // OK_AVX2
+};
+
+// Capacities are powers of two and at least one group wide
+static inline size_t table_capacity(size_t requested) {
+    return round_up_pow2(requested > TableGroup::WIDTH ? requested : TableGroup::WIDTH);
 }
 
-template <typename T>
-Slice<T> List<T>::slice(size_t start) const {
-    return slice(start, count);
+// Capacity that can hold `elements` entries without going over the load limit
+static inline size_t table_capacity_for(size_t elements) {
+    return table_capacity(elements + elements / 7 + 1);
 }
 
-template <typename T>
-Slice<T> List<T>::slice() const {
-    return slice(0, count);
+// A removed slot only needs a tombstone if probes could have walked past its group
+static inline uint8_t table_removed_meta(const uint8_t* meta, size_t idx) {
+    TableGroup group{meta + (idx & ~(TableGroup::WIDTH - 1))};
+    return group.match_empty().any() ? OK_TAB_META_EMPTY : OK_TAB_META_DELETED;
 }
 
-// TABLE IMPLEMENTATION
-template <typename K, typename V>
-Table<K, V> Table<K, V>::alloc(Allocator* a, size_t capacity) {
-    Table<K, V> tab{};
+// Walks the groups a hash can live in, visiting every group once
+struct TableProbe {
+    TableProbe(uint64_t hash, size_t capacity)
+        : mask{capacity / TableGroup::WIDTH - 1}, group{OK_TAB_H1(hash) & mask}, step{0} {}
 
-    tab.keys = a->alloc<K>(capacity);
-    tab.values = a->alloc<V>(capacity);
-    tab.meta = a->alloc<Meta>(capacity);
-    tab.count = 0;
-    tab.capacity = capacity;
-    tab.allocator = a;
+    inline size_t offset() const {
+        return group * TableGroup::WIDTH;
+    }
 
-    return tab;
-}
+    inline void next() {
+        step++;
+        group = (group + step) & mask;
+    }
 
-template <typename K, typename V>
-void Table<K, V>::put(const K& key, const V& value) {
-    if (load_percentage() >= 70) {
-        auto new_table = Table<K, V>::alloc(allocator, OK_TABLE_GROWTH_FACTOR(capacity));
+    size_t mask;
+    size_t group;
+    size_t step;
+};
 
-        for (size_t i = 0; i < capacity; i++) {
-            if (OK_TAB_IS_OCCUPIED(meta[i])) {
-                new_table.put(keys[i], values[i]);
-            }
-        }
+// Keys that convert to the table's key type are looked up as that type, so that e.g. an int
+// literal hashes like the size_t keys it is compared with. Other types are looked up as is.
+template <typename K, typename Q>
+using TableLookup = typename std::conditional<std::is_convertible<const Q&, K>::value, K, Q>::type;
+
+// How a Table lays out its entries. SOA keeps the keys and the values in separate arrays,
+// so probing past big values stays cheap and no padding is wasted between them. AOS interleaves
+// them, so a hit finds its value next to the key. Which one wins depends on the entry sizes and
+// the access pattern, bench/containers.cpp compares the two
+enum class TableLayout : uint8_t {
+    SOA,
+    AOS,
+};
 
-        *this = new_table;
-    }
+template <typename K, typename V, TableLayout LAYOUT>
+struct TableStorage;
 
-    uint64_t idx = Hash<K>::hash(key) % capacity;
+template <typename K, typename V>
+struct TableStorage<K, V, TableLayout::SOA> {
+    inline K& key_at(size_t idx) const {
+        return keys[idx];
+    }
 
-    while (true) {
-        if (OK_TAB_IS_FREE(meta[idx])) {
-            meta[idx] |= OK_TAB_META_OCCUPIED;
-            values[idx] = value;
-            keys[idx] = key;
-            count++;
-            return;
-        }
+    inline V& value_at(size_t idx) const {
+        return values[idx];
+    }
 
-        if (keys[idx] == key) {
-            values[idx] = value;
-            keys[idx] = key;
-            return;
-        }
+    template <typename A>
+    inline void alloc_slots(A* a, size_t capacity) {
+        keys = allocator_alloc<K>(a, capacity);
+        values = allocator_alloc<V>(a, capacity);
+    }
 
-        idx = (idx + 1) % capacity;
+    template <typename A>
+    inline void dealloc_slots(A* a, size_t capacity) {
+        allocator_dealloc(a, values, capacity);
+        allocator_dealloc(a, keys, capacity);
     }
-}
+
+    K* keys;
+    V* values;
+};
 
 template <typename K, typename V>
-Optional<V> Table<K, V>::get(const K& key) {
-    uint64_t idx = Hash<K>::hash(key) % capacity;
-    uint64_t initial_idx = idx;
+struct TableStorage<K, V, TableLayout::AOS> {
+    inline K& key_at(size_t idx) const {
+        return slots[idx].a;
+    }
 
-    do {
-        if (OK_TAB_IS_OCCUPIED(meta[idx]) && keys[idx] == key) {
-            return values[idx];
-        }
+    inline V& value_at(size_t idx) const {
+        return slots[idx].b;
+    }
 
-        idx = (idx + 1) % capacity;
-    } while (idx != initial_idx);
+    template <typename A>
+    inline void alloc_slots(A* a, size_t capacity) {
+        slots = allocator_alloc<Pair<K, V>>(a, capacity);
+    }
 
-    return {};
-}
+    template <typename A>
+    inline void dealloc_slots(A* a, size_t capacity) {
+        allocator_dealloc(a, slots, capacity);
+    }
 
-template <typename K, typename V>
-bool Table<K, V>::has(const K& key) {
-    uint64_t idx = Hash<K>::hash(key) % capacity;
-    uint64_t initial_idx = idx;
+    Pair<K, V>* slots;
+};
 
-    do {
-        if (OK_TAB_IS_OCCUPIED(meta[idx]) && keys[idx] == key) {
-            return true;
-        }
+// Like List, a Table can be given a concrete allocator type to have its allocations inlined
+template <typename K, typename V, TableLayout LAYOUT = TableLayout::SOA, typename A = Allocator>
+struct Table : public TableStorage<K, V, LAYOUT> {
+    using Meta = uint8_t;
 
-        idx = (idx + 1) % capacity;
-    } while (idx != initial_idx);
+    // Walks the occupied slots a group of control bytes at a time. `Value` is const V for const tables
+    template <typename Value>
+    struct BasicIterator {
+        struct Entry {
+            const K* key;
+            Value* value;
+        };
 
-    return false;
-}
+        bool next(Entry* out);
 
-// SET IMPLEMENTATION
-template <typename T>
-Set<T> Set<T>::alloc(Allocator* a, size_t capacity) {
-    Set<T> set;
-    set.allocator = a;
-    set.count = 0;
-    set.capacity = capacity;
-    set.values = a->alloc<T>(capacity);
-    set.meta = a->alloc<Meta>(capacity);
-    return set;
-}
+        const Table* table;
+        size_t group;
+        TableGroup::Mask mask;
+    };
 
-template <typename T>
-void Set<T>::put(const T& elem) {
-    if (load_percentage() >= 70) {
-        auto new_set = Set<T>::alloc(allocator, OK_SET_GROWTH_FACTOR(capacity));
+    using Iterator = BasicIterator<V>;
+    using ConstIterator = BasicIterator<const V>;
 
-        for (size_t i = 0; i < capacity; i++) {
-            if (OK_TAB_IS_FREE(meta[i])) {
-                continue;
-            }
+    static Table<K, V, LAYOUT, A> alloc(A* a, size_t capacity = Table::DEFAULT_CAPACITY);
 
-            new_set.put(values[i]);
-        }
+    void put(const K& key, const V& value);
 
-        *this = new_set;
+    // Lookups accept any type that hashes like K and can be compared with it,
+    // e.g. a Table<String, V> can be queried with a StringView
+    template <typename Q = K>
+    Optional<V> get(const Q& key);
+    template <typename Q = K>
+    bool has(const Q& key);
+    template <typename Q = K>
+    bool remove(const Q& key);
+
+    // Returns a pointer to the key's value, or nullptr. The pointer is invalidated by the next insertion.
+    template <typename Q = K>
+    V* get_ptr(const Q& key);
+    // Returns a pointer to the key's value, inserting `value` first if the key is absent
+    V* get_or_insert(const K& key, const V& value);
+
+    // Makes room for `elements` entries so that no growth happens while inserting them
+    void reserve(size_t elements);
+    // Gets rid of the tombstones without reallocating
+    void rehash();
+    void free();
+
+    static constexpr size_t DEFAULT_CAPACITY = 64;
+
+    // Returns the slot holding the key, or (size_t)-1
+    template <typename Q>
+    size_t find_index(const Q& key, uint64_t hash) const;
+    // Returns the first empty or deleted slot the hash can be inserted at
+    size_t find_free_index(uint64_t hash) const;
+    // Claims a slot for a key that is not in the table yet, growing it if needed
+    size_t insert_index(uint64_t hash);
+
+    void resize(size_t new_capacity);
+
+    inline size_t max_load() const {
+        return capacity - capacity / 8;
     }
 
-    uint64_t hash = Hash<T>::hash(elem);
+    inline uint8_t load_percentage() const {
+        return (uint8_t)((double)(count * 100) / (double)capacity);
+    }
 
-    while (true) {
-        if (OK_TAB_IS_FREE(meta[hash])) {
-            meta[hash] |= OK_TAB_META_OCCUPIED;
-            values[hash] = elem;
-            count++;
-            return;
-        }
+    Iterator iter();
+    ConstIterator iter() const;
 
-        if (values[hash] == elem) {
-            values[hash] = elem;
-            return;
-        }
+    uint8_t* meta;
+    size_t count;
+    size_t deleted;
+    size_t capacity;
+    A* allocator;
+};
 
-        hash = (hash + 1) % capacity;
-    }
-}
+#define OK_SET_GROWTH_FACTOR OK_TABLE_GROWTH_FACTOR
 
 template <typename T>
-bool Set<T>::has(const T& elem) const {
-    uint64_t hash = Hash<T>::hash(elem);
-    uint64_t idx = hash;
+struct Set {
+    using Meta = uint8_t;
 
-    do {
-        if (OK_TAB_IS_OCCUPIED(meta[idx]) && values[idx] == elem) {
-            return true;
-        }
+    static constexpr size_t DEFAULT_CAPACITY = 64;
 
-        idx = (idx + 1) % capacity;
-    } while (idx != hash);
+    static Set<T> alloc(Allocator* a, size_t capacity = DEFAULT_CAPACITY);
 
-    return false;
-}
+    void put(const T& elem);
+    template <typename Q = T>
+    bool has(const Q& elem) const;
+    template <typename Q = T>
+    bool remove(const Q& elem);
 
-// filesystem API
-struct File {
-    enum class OpenError {
-        ACCESS_DENIED,
-        INVALID_PATH,
-        IS_DIRECTORY,
-        TOO_MANY_SYMLINKS,
-        PROCESS_OPEN_FILES_LIMIT_REACHED,
-        SYSTEM_OPEN_FILES_LIMIT_REACHED,
-        PATH_TOO_LONG,
-        KERNEL_OUT_OF_MEMORY,
-        OUT_OF_SPACE,
-        IS_SOCKET,
-        FILE_TOO_BIG,
-        READONLY_FILE,
-    };
+    void reserve(size_t elements);
+    void rehash();
+    void free();
 
-    enum class ReadError {
-        IO_ERROR,
+    template <typename Q>
+    size_t find_index(const Q& elem, uint64_t hash) const;
+    size_t find_free_index(uint64_t hash) const;
+
+    void resize(size_t new_capacity);
+
+    inline size_t max_load() const {
+        return capacity - capacity / 8;
+    }
+
+    inline uint8_t load_percentage() const {
+        return (uint8_t)(100.0 * (double)count / (double)capacity);
+    }
+
+    Allocator* allocator;
+    size_t capacity;
+    size_t count;
+    size_t deleted;
+    T* values;
+    uint8_t* meta;
+};
+
+// An interned string. Symbols from the same interner are equal exactly when their strings are
+struct Symbol {
+    inline bool operator ==(Symbol other) const {
+        return id == other.id;
+    }
+
+    inline bool operator !=(Symbol other) const {
+        return id != other.id;
+    }
+
+    // Orders by interning order, not by the strings
+    inline bool operator <(Symbol other) const {
+        return id < other.id;
+    }
+
+    uint32_t id;
+};
+
+template <>
+struct Hash<Symbol> {
+    static uint64_t hash(Symbol symbol) {
+        return ::ok::hash::mix(symbol.id, ::ok::hash::default_seed);
+    }
+};
+
+// Keeps one copy of every distinct string and numbers them densely from 0. The bytes are packed
+// into an arena of the interner's own, so the views it hands out stay valid until it is freed
+struct StringInterner {
+    static constexpr size_t DEFAULT_CAPACITY = 256;
+
+    static StringInterner alloc(Allocator* a, size_t capacity = DEFAULT_CAPACITY);
+
+    // Copies the string in the first time it is seen
+    Symbol intern(StringView string);
+    // Looks the string up without interning it
+    Optional<Symbol> find(StringView string) const;
+
+    inline StringView view(Symbol symbol) const {
+        return strings[symbol.id];
+    }
+
+    inline size_t count() const {
+        return strings.count;
+    }
+
+    void free();
+
+    ArenaAllocator bytes;
+    // indexed by Symbol::id
+    List<StringView> strings;
+    Table<StringView, uint32_t> ids;
+};
+
+// Bounded lock-free ring for exactly one producer thread and one consumer thread.
+// The capacity is rounded up to a power of two. The queue must not be moved after init
+template <typename T>
+struct SpscQueue {
+    static constexpr size_t DEFAULT_CAPACITY = 1024;
+
+    static void init(SpscQueue<T>* out, Allocator* a, size_t capacity = DEFAULT_CAPACITY);
+
+    // Producer side, fails when the queue is full
+    bool push(const T& item);
+    bool push(T&& item);
+    // Copies as many items as fit, returns how many did
+    size_t push_n(Slice<T> items);
+
+    // Consumer side, fails when the queue is empty
+    bool pop(T* out);
+    // Moves up to `max_count` items into `out`, which must hold constructed items
+    Slice<T> pop_n(T* out, size_t max_count);
+
+    // Only a snapshot while the other side is running
+    size_t count() const;
+
+    // Destroys the items left in the queue, neither side may be running
+    void free();
+
+    Allocator* allocator;
+    T* items;
+    size_t mask;
+
+    // Each side caches the other's index so it only touches the shared line when it looks stuck
+    alignas(OK_CACHE_LINE_SIZE) std::atomic<size_t> head;
+    size_t cached_tail;
+
+    alignas(OK_CACHE_LINE_SIZE) std::atomic<size_t> tail;
+    size_t cached_head;
+};
+
+// Bounded lock-free ring for any number of producers and consumers. Every cell carries a
+// sequence number telling whose turn it is, so the two sides only contend on their own index.
+// The capacity is rounded up to a power of two. The queue must not be moved after init
+template <typename T>
+struct MpmcQueue {
+    struct Cell {
+        inline T* value() {
+            return (T*)(void*)storage;
+        }
+
+        std::atomic<size_t> sequence;
+        alignas(T) uint8_t storage[sizeof(T)];
     };
 
-    static Optional<OpenError> open(File* out, const char* path);
+    static constexpr size_t DEFAULT_CAPACITY = 1024;
 
-    void seek_start() const;
-    off_t seek_end() const;
+    static void init(MpmcQueue<T>* out, Allocator* a, size_t capacity = DEFAULT_CAPACITY);
 
-    Optional<ReadError> read(uint8_t* buf, size_t count);
+    bool push(const T& item);
+    bool push(T&& item);
+    // Claims a run of free cells at once, returns how many items were copied in
+    size_t push_n(Slice<T> items);
 
-    Optional<ReadError> read_full(Allocator* a, List<uint8_t>* out);
+    bool pop(T* out);
+    // Claims a run of full cells at once and moves them into `out`
+    Slice<T> pop_n(T* out, size_t max_count);
 
-    size_t size() const;
+    size_t count() const;
 
-    int fd;
-    const char* path;
+    void free();
+
+    Allocator* allocator;
+    Cell* cells;
+    size_t mask;
+
+    alignas(OK_CACHE_LINE_SIZE) std::atomic<size_t> head;
+    alignas(OK_CACHE_LINE_SIZE) std::atomic<size_t> tail;
 };
 
-// procedures
+// HASH IMPLEMENTATION
 template <typename T>
-const T& max(const T& a) {
-    return a;
+bool operator ==(const HashPtr<T>& lhs, const HashPtr<T>& rhs) {
+    return *lhs.value == *rhs.value;
 }
 
-template <typename T, typename... Rest>
-const T& max(const T& x, const Rest&... xs) {
-    const T& xs_max = max(xs...);
-    return x > xs_max ? x : xs_max;
+// OPTIONAL IMPLEMENTATION
+template <typename T>
+const Optional<T> Optional<T>::NONE = Optional<T>{};
+
+template <typename T>
+const Optional<T> Optional<T*>::NONE = Optional<T*>{};
+
+// LIST IMPLEMENTATION
+template <typename T, typename A>
+List<T, A> List<T, A>::alloc(A* a, size_t cap) {
+    List<T, A> list{};
+    list.items = allocator_alloc<T>(a, cap);
+    list.count = 0;
+    list.capacity = cap;
+    list.allocator = a;
+
+    return list;
+}
+
+// Aggregates have no constructors to call with parentheses before C++20
+template <typename T, typename... Args>
+inline T* _construct_in_place(std::true_type, T* at, Args&&... args) {
+    return new ((void*)at) T(std::forward<Args>(args)...);
+}
+
+template <typename T, typename... Args>
+inline T* _construct_in_place(std::false_type, T* at, Args&&... args) {
+    return new ((void*)at) T{std::forward<Args>(args)...};
+}
+
+template <typename T, typename... Args>
+inline T* _construct_at(T* at, Args&&... args) {
+    return _construct_in_place(std::is_constructible<T, Args&&...>{}, at, std::forward<Args>(args)...);
 }
 
 template <typename T>
-const T& min(const T& a) {
-    return a;
+inline void _destroy_items(T* items, size_t n, std::true_type) {
+    OK_UNUSED(items);
+    OK_UNUSED(n);
 }
 
-template <typename T, typename... Rest>
-const T& min(const T& x, const Rest&... xs) {
-    const T& xs_min = min(xs...);
-    return x < xs_min ? x : xs_min;
+template <typename T>
+inline void _destroy_items(T* items, size_t n, std::false_type) {
+    for (size_t i = 0; i < n; i++) items[i].~T();
 }
 
-void println(const char*);
-void println(StringView);
-void println(String);
+// Bulk copies, trivially copyable items are moved around with memcpy/memmove
+template <typename T>
+inline void _copy_items(T* dest, const T* source, size_t n, std::true_type) {
+    if (n > 0) memcpy((void*)dest, (const void*)source, n * sizeof(T));
+}
 
-void eprintln(const char*);
-void eprintln(String);
-void eprintln(StringView);
+template <typename T>
+inline void _copy_items(T* dest, const T* source, size_t n, std::false_type) {
+    for (size_t i = 0; i < n; i++) new ((void*)&dest[i]) T(source[i]);
+}
 
-String to_string(Allocator*, int32_t);
-String to_string(Allocator*, uint32_t);
-String to_string(Allocator*, int64_t);
-String to_string(Allocator*, uint64_t);
+// Moves dest[1..n] one slot down over dest[0], the last slot is left unconstructed
+template <typename T>
+inline void _shift_items_down(T* dest, size_t n, std::true_type) {
+    if (n > 0) memmove((void*)dest, (const void*)(dest + 1), n * sizeof(T));
+}
 
-bool parse_int64(StringView, int64_t*);
+template <typename T>
+inline void _shift_items_down(T* dest, size_t n, std::false_type) {
+    for (size_t i = 0; i < n; i++) dest[i] = std::move(dest[i + 1]);
+    dest[n].~T();
+}
 
-#ifdef OK_IMPLEMENTATION
+template <typename T, typename A>
+inline T* _relocate_items(A* a, T* items, size_t count, size_t old_cap, size_t new_cap, std::true_type) {
+    OK_UNUSED(count);
+    return allocator_resize(a, items, old_cap, new_cap);
+}
 
-FixedBufferAllocator _temp_allocator_impl{};
-Allocator* temp_allocator = &_temp_allocator_impl;
+template <typename T, typename A>
+inline T* _relocate_items(A* a, T* items, size_t count, size_t old_cap, size_t new_cap, std::false_type) {
+    T* new_items = allocator_alloc<T>(a, new_cap);
 
-ArenaAllocator _static_allocator_impl{};
-Allocator* static_allocator = &_static_allocator_impl;
+    for (size_t i = 0; i < count; i++) {
+        new ((void*)&new_items[i]) T(std::move(items[i]));
+        items[i].~T();
+    }
 
-static void _init_region(ArenaAllocator::Region* region, size_t size) {
-    region->data = (uint8_t*)OK_ALLOC_PAGE(size);
-    OK_ASSERT(region->data != (void*)-1);
-    region->size = size;
-    region->off = 0;
-    region->next = nullptr;
+    allocator_dealloc(a, items, old_cap);
+    return new_items;
 }
 
-// ALLOCATORS IMPLEMENTATION
-void* FixedBufferAllocator::raw_alloc(size_t size) {
-    size = align_to(size, sizeof(void*));
+template <typename T, typename A>
+void List<T, A>::push(const T& item) {
+    if (count >= capacity) {
+        // `item` may live in the buffer that is about to move
+        T copy(item);
+        reserve(OK_LIST_GROW_FACTOR(capacity));
+        new ((void*)&items[count++]) T(std::move(copy));
+        return;
+    }
 
-    if (buffer == nullptr) {
-        buffer_size = max(size, OK_PAGE_SIZE * FixedBufferAllocator::DEFAULT_PAGE_COUNT);
-        buffer_size = align_to(buffer_size, OK_PAGE_ALIGN);
-        buffer = OK_ALLOC_PAGE(buffer_size);
-        buffer_off = 0;
+    new ((void*)&items[count++]) T(item);
+}
+
+template <typename T, typename A>
+void List<T, A>::push(T&& item) {
+    if (count >= capacity) {
+        T moved(std::move(item));
+        reserve(OK_LIST_GROW_FACTOR(capacity));
+        new ((void*)&items[count++]) T(std::move(moved));
+        return;
     }
 
-    if (size > buffer_size) return nullptr;
+    new ((void*)&items[count++]) T(std::move(item));
+}
 
-    if (buffer_size - buffer_off < size) {
-        buffer_off = size;
-        return buffer;
+template <typename T, typename A>
+template <typename... Args>
+T& List<T, A>::emplace(Args&&... args) {
+    if (count >= capacity) {
+        // `args` may refer to items in the buffer that is about to move, so the item is built first
+        alignas(T) unsigned char storage[sizeof(T)];
+        T* built = _construct_at((T*)storage, std::forward<Args>(args)...);
+
+        reserve(OK_LIST_GROW_FACTOR(capacity));
+
+        T* item = new ((void*)&items[count++]) T(std::move(*built));
+        built->~T();
+        return *item;
     }
 
-    auto* ptr = (uint8_t*)buffer + buffer_off;
-    buffer_off += size;
-    return (void*)ptr;
+    T* item = _construct_at(&items[count], std::forward<Args>(args)...);
+    count++;
+    return *item;
 }
 
-void FixedBufferAllocator::raw_dealloc(void* ptr, size_t size) {
-    if (ptr == (void*)((uint8_t*)buffer + buffer_off)) buffer_off -= size;
+template <typename T, typename A>
+void List<T, A>::append_many(const T* source, size_t n) {
+    if (count + n > capacity) {
+        // `source` may live in the buffer that is about to move, e.g. list.extend(list.slice())
+        uintptr_t offset = (uintptr_t)source - (uintptr_t)items;
+        bool aliased = (uintptr_t)source >= (uintptr_t)items && offset < capacity * sizeof(T);
+
+        size_t grown = OK_LIST_GROW_FACTOR(capacity);
+        reserve(count + n > grown ? count + n : grown);
+
+        if (aliased) source = (const T*)((const uint8_t*)items + offset);
+    }
+
+    _copy_items(items + count, source, n, std::is_trivially_copyable<T>{});
+    count += n;
 }
 
-ArenaAllocator::Region* ArenaAllocator::alloc_region(size_t region_size) {
-    using Region = ArenaAllocator::Region;
+template <typename T, typename A>
+inline void List<T, A>::remove_at(size_t idx) {
+    OK_ASSERT(idx < count);
 
-    region_size = align_to(region_size, OK_PAGE_ALIGN);
+    _shift_items_down(items + idx, count - idx - 1, std::is_trivially_copyable<T>{});
+    count--;
+}
 
-    Region* current_region = region_pool;
+template <typename T, typename A>
+inline List<T, A> List<T, A>::copy(A* a, size_t start, size_t end) const {
+    OK_ASSERT(end >= start);
 
-    while (current_region) {
-        if (current_region->size - current_region->off >= sizeof(Region)) {
-            auto* region = (Region*)((uint8_t*)current_region->data + current_region->off);
+    auto res = List<T, A>::alloc(a, end - start);
+    res.append_many(items + start, end - start);
+    return res;
+}
+
+template <typename T, typename A>
+inline void List<T, A>::extend(Slice<T> other) {
+    append_many(other.items, other.count);
+}
+
+template <typename T, typename A>
+inline void List<T, A>::extend(List<T, A> other) {
+    append_many(other.items, other.count);
+}
+
+template <typename T, typename A>
+inline void List<T, A>::reserve(size_t new_cap) {
+    if (new_cap <= capacity) {
+        return;
+    }
+
+    items = _relocate_items(allocator, items, count, capacity, new_cap, IsTriviallyRelocatable<T>{});
+    capacity = new_cap;
+}
+
+template <typename T, typename A>
+inline void List<T, A>::clear() {
+    _destroy_items(items, count, std::is_trivially_destructible<T>{});
+    count = 0;
+}
+
+template <typename T, typename A>
+inline void List<T, A>::free() {
+    clear();
+    allocator_dealloc(allocator, items, capacity);
+    items = nullptr;
+    capacity = 0;
+}
+
+template <typename T, typename A>
+inline size_t List<T, A>::find_index(const T& elem) {
+    for (size_t i = 0; i < count; i++) {
+        if (items[i] == elem) {
+            return i;
+        }
+    }
+
+    return (size_t)-1;
+}
+
+template <typename T, typename A>
+template <typename F>
+inline size_t List<T, A>::find_index(F pred) {
+    for (size_t i = 0; i < count; i++) {
+        if (pred(items[i])) {
+            return i;
+        }
+    }
+
+    return (size_t)-1;
+}
+
+template <typename T, typename A>
+Slice<T> List<T, A>::slice(size_t start, size_t end) const {
+    OK_ASSERT(end >= start);
+    return Slice<T>{items + start, end - start};
+}
+
+template <typename T, typename A>
+Slice<T> List<T, A>::slice(size_t start) const {
+    return slice(start, count);
+}
+
+template <typename T, typename A>
+Slice<T> List<T, A>::slice() const {
+    return slice(0, count);
+}
+
+// SORTING IMPLEMENTATION
+static constexpr size_t _INSERTION_SORT_THRESHOLD = 24;
+static constexpr size_t _NINTHER_THRESHOLD = 128;
+static constexpr size_t _PARTIAL_INSERTION_SORT_LIMIT = 8;
+
+template <typename T, typename Compare>
+inline void _insertion_sort(T* begin, T* end, Compare& less) {
+    if (begin == end) return;
+
+    for (T* cur = begin + 1; cur != end; cur++) {
+        T* sift = cur;
+        T* sift_1 = cur - 1;
+
+        if (less(*sift, *sift_1)) {
+            T tmp = std::move(*sift);
+
+            do {
+                *sift-- = std::move(*sift_1);
+            } while (sift != begin && less(tmp, *--sift_1));
+
+            *sift = std::move(tmp);
+        }
+    }
+}
+
+// The item before `begin` must not be greater than any item in [begin, end)
+template <typename T, typename Compare>
+inline void _unguarded_insertion_sort(T* begin, T* end, Compare& less) {
+    if (begin == end) return;
+
+    for (T* cur = begin + 1; cur != end; cur++) {
+        T* sift = cur;
+        T* sift_1 = cur - 1;
+
+        if (less(*sift, *sift_1)) {
+            T tmp = std::move(*sift);
+
+            do {
+                *sift-- = std::move(*sift_1);
+            } while (less(tmp, *--sift_1));
+
+            *sift = std::move(tmp);
+        }
+    }
+}
+
+// Gives up and returns false once more than a few items had to be moved
+template <typename T, typename Compare>
+inline bool _partial_insertion_sort(T* begin, T* end, Compare& less) {
+    if (begin == end) return true;
+
+    size_t moved = 0;
+
+    for (T* cur = begin + 1; cur != end; cur++) {
+        T* sift = cur;
+        T* sift_1 = cur - 1;
+
+        if (less(*sift, *sift_1)) {
+            T tmp = std::move(*sift);
+
+            do {
+                *sift-- = std::move(*sift_1);
+            } while (sift != begin && less(tmp, *--sift_1));
+
+            *sift = std::move(tmp);
+            moved += (size_t)(cur - sift);
+        }
+
+        if (moved > _PARTIAL_INSERTION_SORT_LIMIT) return false;
+    }
+
+    return true;
+}
+
+template <typename T, typename Compare>
+inline void _sort2(T* a, T* b, Compare& less) {
+    if (less(*b, *a)) std::swap(*a, *b);
+}
+
+template <typename T, typename Compare>
+inline void _sort3(T* a, T* b, T* c, Compare& less) {
+    _sort2(a, b, less);
+    _sort2(b, c, less);
+    _sort2(a, b, less);
+}
+
+template <typename T, typename Compare>
+void _sift_down(T* items, size_t root, size_t count, Compare& less) {
+    T value = std::move(items[root]);
+
+    while (true) {
+        size_t child = 2 * root + 1;
+        if (child >= count) break;
+        if (child + 1 < count && less(items[child], items[child + 1])) child++;
+        if (!less(value, items[child])) break;
+
+        items[root] = std::move(items[child]);
+        root = child;
+    }
+
+    items[root] = std::move(value);
+}
+
+template <typename T, typename Compare>
+void _heap_sort(T* begin, T* end, Compare& less) {
+    size_t count = (size_t)(end - begin);
+
+    for (size_t i = count / 2; i-- > 0;) _sift_down(begin, i, count, less);
+
+    for (size_t last = count - 1; last > 0; last--) {
+        std::swap(begin[0], begin[last]);
+        _sift_down(begin, 0, last, less);
+    }
+}
+
+// Partitions around *begin, items equal to the pivot end up on the right.
+// `already_partitioned` is set when no items had to be swapped
+template <typename T, typename Compare>
+T* _partition_right(T* begin, T* end, Compare& less, bool* already_partitioned) {
+    T pivot = std::move(*begin);
+    T* first = begin;
+    T* last = end;
+
+    // the median selection guarantees that these scans stop
+    while (less(*++first, pivot));
+
+    if (first - 1 == begin) {
+        while (first < last && !less(*--last, pivot));
+    } else {
+        while (!less(*--last, pivot));
+    }
+
+    *already_partitioned = first >= last;
+
+    while (first < last) {
+        std::swap(*first, *last);
+        while (less(*++first, pivot));
+        while (!less(*--last, pivot));
+    }
+
+    T* pivot_pos = first - 1;
+    *begin = std::move(*pivot_pos);
+    *pivot_pos = std::move(pivot);
+
+    return pivot_pos;
+}
+
+// Partitions around *begin with items equal to the pivot on the left. Used when the pivot
+// equals the item before the range, so the equal items are already in their final place
+template <typename T, typename Compare>
+T* _partition_left(T* begin, T* end, Compare& less) {
+    T pivot = std::move(*begin);
+    T* first = begin;
+    T* last = end;
+
+    while (less(pivot, *--last));
+
+    if (last + 1 == end) {
+        while (first < last && !less(pivot, *++first));
+    } else {
+        while (!less(pivot, *++first));
+    }
+
+    while (first < last) {
+        std::swap(*first, *last);
+        while (less(pivot, *--last));
+        while (!less(pivot, *++first));
+    }
+
+    T* pivot_pos = last;
+    *begin = std::move(*pivot_pos);
+    *pivot_pos = std::move(pivot);
+
+    return pivot_pos;
+}
+
+template <typename T, typename Compare>
+void _pdqsort_loop(T* begin, T* end, Compare& less, int bad_allowed, bool leftmost) {
+    while (true) {
+        size_t size = (size_t)(end - begin);
+
+        if (size < _INSERTION_SORT_THRESHOLD) {
+            if (leftmost) _insertion_sort(begin, end, less);
+            else _unguarded_insertion_sort(begin, end, less);
+            return;
+        }
+
+        // the pivot ends up in *begin
+        size_t half = size / 2;
+
+        if (size > _NINTHER_THRESHOLD) {
+            _sort3(begin, begin + half, end - 1, less);
+            _sort3(begin + 1, begin + (half - 1), end - 2, less);
+            _sort3(begin + 2, begin + (half + 1), end - 3, less);
+            _sort3(begin + (half - 1), begin + half, begin + (half + 1), less);
+            std::swap(*begin, *(begin + half));
+        } else {
+            _sort3(begin + half, begin, end - 1, less);
+        }
+
+        if (!leftmost && !less(*(begin - 1), *begin)) {
+            begin = _partition_left(begin, end, less) + 1;
+            continue;
+        }
+
+        bool already_partitioned;
+        T* pivot_pos = _partition_right(begin, end, less, &already_partitioned);
+
+        size_t left_size = (size_t)(pivot_pos - begin);
+        size_t right_size = (size_t)(end - (pivot_pos + 1));
+        bool highly_unbalanced = left_size < size / 8 || right_size < size / 8;
+
+        if (highly_unbalanced) {
+            if (--bad_allowed == 0) {
+                _heap_sort(begin, end, less);
+                return;
+            }
+
+            // break up the patterns that led to the bad partition
+            if (left_size >= _INSERTION_SORT_THRESHOLD) {
+                std::swap(begin[0], begin[left_size / 4]);
+                std::swap(pivot_pos[-1], pivot_pos[-(ptrdiff_t)(left_size / 4)]);
+
+                if (left_size > _NINTHER_THRESHOLD) {
+                    std::swap(begin[1], begin[left_size / 4 + 1]);
+                    std::swap(begin[2], begin[left_size / 4 + 2]);
+                    std::swap(pivot_pos[-2], pivot_pos[-(ptrdiff_t)(left_size / 4 + 1)]);
+                    std::swap(pivot_pos[-3], pivot_pos[-(ptrdiff_t)(left_size / 4 + 2)]);
+                }
+            }
+
+            if (right_size >= _INSERTION_SORT_THRESHOLD) {
+                std::swap(pivot_pos[1], pivot_pos[1 + right_size / 4]);
+                std::swap(end[-1], end[-(ptrdiff_t)(right_size / 4)]);
+
+                if (right_size > _NINTHER_THRESHOLD) {
+                    std::swap(pivot_pos[2], pivot_pos[2 + right_size / 4]);
+                    std::swap(pivot_pos[3], pivot_pos[3 + right_size / 4]);
+                    std::swap(end[-2], end[-(ptrdiff_t)(1 + right_size / 4)]);
+                    std::swap(end[-3], end[-(ptrdiff_t)(2 + right_size / 4)]);
+                }
+            }
+        } else if (already_partitioned
+                   && _partial_insertion_sort(begin, pivot_pos, less)
+                   && _partial_insertion_sort(pivot_pos + 1, end, less)) {
+            // the input was most likely sorted already
+            return;
+        }
+
+        _pdqsort_loop(begin, pivot_pos, less, bad_allowed, leftmost);
+        begin = pivot_pos + 1;
+        leftmost = false;
+    }
+}
+
+template <typename T, typename Compare>
+void sort(T* items, size_t count, Compare less) {
+    if (count < 2) return;
+
+    int bad_allowed = 64 - (int)count_leading_zeros(count);
+    _pdqsort_loop(items, items + count, less, bad_allowed, true);
+}
+
+template <typename T, typename Compare>
+void _merge_sort(T* items, size_t count, T* scratch, Compare& less) {
+    if (count <= _INSERTION_SORT_THRESHOLD) {
+        _insertion_sort(items, items + count, less);
+        return;
+    }
+
+    size_t mid = count / 2;
+    _merge_sort(items, mid, scratch, less);
+    _merge_sort(items + mid, count - mid, scratch, less);
+
+    if (!less(items[mid], items[mid - 1])) return;
+
+    // the left run moves out of the way, ties are taken from it to keep the sort stable
+    for (size_t i = 0; i < mid; i++) new ((void*)&scratch[i]) T(std::move(items[i]));
+
+    size_t left = 0;
+    size_t right = mid;
+    size_t out = 0;
+
+    while (left < mid && right < count) {
+        if (less(items[right], scratch[left])) items[out++] = std::move(items[right++]);
+        else items[out++] = std::move(scratch[left++]);
+    }
+
+    while (left < mid) items[out++] = std::move(scratch[left++]);
+
+    _destroy_items(scratch, mid, std::is_trivially_destructible<T>{});
+}
+
+template <typename T, typename Compare>
+void stable_sort(T* items, size_t count, Allocator* scratch, Compare less) {
+    if (count < 2) return;
+
+    if (count <= _INSERTION_SORT_THRESHOLD) {
+        _insertion_sort(items, items + count, less);
+        return;
+    }
+
+    size_t scratch_count = count / 2;
+    T* buffer = scratch->alloc<T>(scratch_count);
+    _merge_sort(items, count, buffer, less);
+    scratch->dealloc(buffer, scratch_count);
+}
+
+template <typename T, typename Key>
+void radix_sort(T* items, size_t count, Allocator* scratch, Key key) {
+    using K = typename std::decay<decltype(key(items[0]))>::type;
+    using U = typename std::make_unsigned<K>::type;
+
+    static_assert(std::is_integral<K>::value, "radix_sort keys have to be integers");
+    static_assert(std::is_trivially_copyable<T>::value, "radix_sort copies items between buffers");
+
+    if (count <= _INSERTION_SORT_THRESHOLD) {
+        auto less = [&](const T& a, const T& b) { return key(a) < key(b); };
+        _insertion_sort(items, items + count, less);
+        return;
+    }
+
+    static constexpr size_t PASSES = sizeof(U);
+
+    // flipping the sign bit orders signed keys like unsigned ones
+    const U flip = std::is_signed<K>::value ? (U)((U)1 << (sizeof(U) * 8 - 1)) : (U)0;
+
+    size_t counts[PASSES][256] = {};
+
+    for (size_t i = 0; i < count; i++) {
+        U k = (U)((U)key(items[i]) ^ flip);
+        for (size_t pass = 0; pass < PASSES; pass++) counts[pass][(k >> (pass * 8)) & 0xFF]++;
+    }
+
+    T* buffer = scratch->alloc<T>(count);
+    T* from = items;
+    T* to = buffer;
+
+    for (size_t pass = 0; pass < PASSES; pass++) {
+        U first = (U)((U)key(from[0]) ^ flip);
+
+        // every key has the same digit in this position
+        if (counts[pass][(first >> (pass * 8)) & 0xFF] == count) continue;
+
+        size_t offset = 0;
+        for (size_t digit = 0; digit < 256; digit++) {
+            size_t n = counts[pass][digit];
+            counts[pass][digit] = offset;
+            offset += n;
+        }
+
+        for (size_t i = 0; i < count; i++) {
+            U k = (U)((U)key(from[i]) ^ flip);
+            to[counts[pass][(k >> (pass * 8)) & 0xFF]++] = from[i];
+        }
+
+        T* tmp = from;
+        from = to;
+        to = tmp;
+    }
+
+    if (from != items) memcpy((void*)items, (const void*)from, count * sizeof(T));
+    scratch->dealloc(buffer, count);
+}
+
+template <typename T>
+void radix_sort(T* items, size_t count, Allocator* scratch) {
+    radix_sort(items, count, scratch, [](const T& value) { return value; });
+}
+
+template <typename T, typename A>
+template <typename Compare>
+inline void List<T, A>::sort(Compare less) {
+    ok::sort(items, count, less);
+}
+
+template <typename T, typename A>
+template <typename Compare>
+inline void List<T, A>::stable_sort(Allocator* scratch, Compare less) {
+    ok::stable_sort(items, count, scratch, less);
+}
+
+template <typename T, typename A>
+inline void List<T, A>::radix_sort(Allocator* scratch) {
+    ok::radix_sort(items, count, scratch);
+}
+
+// TABLE IMPLEMENTATION
+template <typename K, typename V, TableLayout LAYOUT, typename A>
+Table<K, V, LAYOUT, A> Table<K, V, LAYOUT, A>::alloc(A* a, size_t capacity) {
+    Table<K, V, LAYOUT, A> tab{};
+
+    capacity = table_capacity(capacity);
+
+    tab.alloc_slots(a, capacity);
+    tab.meta = allocator_alloc<Meta>(a, capacity);
+    tab.count = 0;
+    tab.deleted = 0;
+    tab.capacity = capacity;
+    tab.allocator = a;
+
+    memset(tab.meta, OK_TAB_META_EMPTY, capacity);
+
+    return tab;
+}
+
+template <typename K, typename V, TableLayout LAYOUT, typename A>
+template <typename Q>
+size_t Table<K, V, LAYOUT, A>::find_index(const Q& key, uint64_t hash) const {
+    uint8_t h2 = OK_TAB_H2(hash);
+
+    for (TableProbe probe{hash, capacity};; probe.next()) {
+        TableGroup group{meta + probe.offset()};
+
+        for (auto match = group.match(h2); match.any(); match.clear_lowest()) {
+            size_t idx = probe.offset() + match.lowest();
+            if (this->key_at(idx) == key) return idx;
+        }
+
+        if (group.match_empty().any()) return (size_t)-1;
+    }
+}
+
+template <typename K, typename V, TableLayout LAYOUT, typename A>
+size_t Table<K, V, LAYOUT, A>::find_free_index(uint64_t hash) const {
+    for (TableProbe probe{hash, capacity};; probe.next()) {
+        auto free = TableGroup{meta + probe.offset()}.match_free();
+        if (free.any()) return probe.offset() + free.lowest();
+    }
+}
+
+template <typename K, typename V, TableLayout LAYOUT, typename A>
+void Table<K, V, LAYOUT, A>::resize(size_t new_capacity) {
+    auto new_table = Table<K, V, LAYOUT, A>::alloc(allocator, new_capacity);
+
+    for (size_t i = 0; i < capacity; i++) {
+        if (OK_TAB_IS_FREE(meta[i])) continue;
+
+        uint64_t hash = Hash<K>::hash(this->key_at(i));
+        size_t idx = new_table.find_free_index(hash);
+
+        new_table.meta[idx] = OK_TAB_H2(hash);
+        new_table.key_at(idx) = this->key_at(i);
+        new_table.value_at(idx) = this->value_at(i);
+    }
+
+    new_table.count = count;
+
+    free();
+    *this = new_table;
+}
+
+template <typename K, typename V, TableLayout LAYOUT, typename A>
+void Table<K, V, LAYOUT, A>::rehash() {
+    if (deleted == 0) return;
+
+    // occupied slots get marked as deleted until they are put into their place
+    for (size_t i = 0; i < capacity; i++) {
+        meta[i] = OK_TAB_IS_OCCUPIED(meta[i]) ? OK_TAB_META_DELETED : OK_TAB_META_EMPTY;
+    }
+
+    size_t i = 0;
+
+    while (i < capacity) {
+        if (meta[i] != OK_TAB_META_DELETED) {
+            i++;
+            continue;
+        }
+
+        uint64_t hash = Hash<K>::hash(this->key_at(i));
+        size_t target = find_free_index(hash);
+
+        if (target / TableGroup::WIDTH == i / TableGroup::WIDTH) {
+            meta[i] = OK_TAB_H2(hash);
+            i++;
+            continue;
+        }
+
+        if (meta[target] == OK_TAB_META_EMPTY) {
+            this->key_at(target) = this->key_at(i);
+            this->value_at(target) = this->value_at(i);
+            meta[target] = OK_TAB_H2(hash);
+            meta[i] = OK_TAB_META_EMPTY;
+            i++;
+            continue;
+        }
+
+        // the target still holds an element that has to be moved, so swap and process it next
+        K key = this->key_at(target);
+        V value = this->value_at(target);
+
+        this->key_at(target) = this->key_at(i);
+        this->value_at(target) = this->value_at(i);
+        meta[target] = OK_TAB_H2(hash);
+
+        this->key_at(i) = key;
+        this->value_at(i) = value;
+    }
+
+    deleted = 0;
+}
+
+template <typename K, typename V, TableLayout LAYOUT, typename A>
+void Table<K, V, LAYOUT, A>::reserve(size_t elements) {
+    size_t new_capacity = table_capacity_for(elements);
+    if (new_capacity > capacity) resize(new_capacity);
+}
+
+template <typename K, typename V, TableLayout LAYOUT, typename A>
+void Table<K, V, LAYOUT, A>::free() {
+    allocator_dealloc(allocator, meta, capacity);
+    this->dealloc_slots(allocator, capacity);
+}
+
+template <typename K, typename V, TableLayout LAYOUT, typename A>
+size_t Table<K, V, LAYOUT, A>::insert_index(uint64_t hash) {
+    if (count + deleted >= max_load()) {
+        // only grow if the table is actually full, otherwise just get rid of the tombstones
+        if (count * 2 >= max_load()) resize(OK_TABLE_GROWTH_FACTOR(capacity));
+        else rehash();
+    }
+
+    size_t idx = find_free_index(hash);
+
+    if (meta[idx] == OK_TAB_META_DELETED) deleted--;
+
+    meta[idx] = OK_TAB_H2(hash);
+    count++;
+
+    return idx;
+}
+
+template <typename K, typename V, TableLayout LAYOUT, typename A>
+void Table<K, V, LAYOUT, A>::put(const K& key, const V& value) {
+    uint64_t hash = Hash<K>::hash(key);
+    size_t idx = find_index(key, hash);
+
+    if (idx != (size_t)-1) {
+        this->value_at(idx) = value;
+        return;
+    }
+
+    idx = insert_index(hash);
+    this->key_at(idx) = key;
+    this->value_at(idx) = value;
+}
+
+template <typename K, typename V, TableLayout LAYOUT, typename A>
+V* Table<K, V, LAYOUT, A>::get_or_insert(const K& key, const V& value) {
+    uint64_t hash = Hash<K>::hash(key);
+    size_t idx = find_index(key, hash);
+
+    if (idx == (size_t)-1) {
+        idx = insert_index(hash);
+        this->key_at(idx) = key;
+        this->value_at(idx) = value;
+    }
+
+    return &this->value_at(idx);
+}
+
+template <typename K, typename V, TableLayout LAYOUT, typename A>
+template <typename Q>
+Optional<V> Table<K, V, LAYOUT, A>::get(const Q& query) {
+    const TableLookup<K, Q>& key = query;
+    size_t idx = find_index(key, Hash<TableLookup<K, Q>>::hash(key));
+    if (idx == (size_t)-1) return Optional<V>::NONE;
+    return this->value_at(idx);
+}
+
+template <typename K, typename V, TableLayout LAYOUT, typename A>
+template <typename Q>
+V* Table<K, V, LAYOUT, A>::get_ptr(const Q& query) {
+    const TableLookup<K, Q>& key = query;
+    size_t idx = find_index(key, Hash<TableLookup<K, Q>>::hash(key));
+    if (idx == (size_t)-1) return nullptr;
+    return &this->value_at(idx);
+}
+
+template <typename K, typename V, TableLayout LAYOUT, typename A>
+template <typename Q>
+bool Table<K, V, LAYOUT, A>::has(const Q& query) {
+    const TableLookup<K, Q>& key = query;
+    return find_index(key, Hash<TableLookup<K, Q>>::hash(key)) != (size_t)-1;
+}
+
+template <typename K, typename V, TableLayout LAYOUT, typename A>
+template <typename Q>
+bool Table<K, V, LAYOUT, A>::remove(const Q& query) {
+    const TableLookup<K, Q>& key = query;
+    size_t idx = find_index(key, Hash<TableLookup<K, Q>>::hash(key));
+    if (idx == (size_t)-1) return false;
+
+    meta[idx] = table_removed_meta(meta, idx);
+    if (meta[idx] == OK_TAB_META_DELETED) deleted++;
+
+    count--;
+    return true;
+}
+
+template <typename K, typename V, TableLayout LAYOUT, typename A>
+typename Table<K, V, LAYOUT, A>::Iterator Table<K, V, LAYOUT, A>::iter() {
+    TableGroup::Mask mask{0};
+    if (capacity > 0) mask = TableGroup{meta}.match_full();
+    return Iterator{this, 0, mask};
+}
+
+template <typename K, typename V, TableLayout LAYOUT, typename A>
+typename Table<K, V, LAYOUT, A>::ConstIterator Table<K, V, LAYOUT, A>::iter() const {
+    TableGroup::Mask mask{0};
+    if (capacity > 0) mask = TableGroup{meta}.match_full();
+    return ConstIterator{this, 0, mask};
+}
+
+template <typename K, typename V, TableLayout LAYOUT, typename A>
+template <typename Value>
+bool Table<K, V, LAYOUT, A>::BasicIterator<Value>::next(Entry* out) {
+    while (!mask.any()) {
+        group += TableGroup::WIDTH;
+        if (group >= table->capacity) return false;
+        mask = TableGroup{table->meta + group}.match_full();
+    }
+
+    size_t idx = group + mask.lowest();
+    mask.clear_lowest();
+
+    out->key = &table->key_at(idx);
+    out->value = &table->value_at(idx);
+    return true;
+}
+
+// SET IMPLEMENTATION
+template <typename T>
+Set<T> Set<T>::alloc(Allocator* a, size_t capacity) {
+    Set<T> set;
+
+    capacity = table_capacity(capacity);
+
+    set.allocator = a;
+    set.count = 0;
+    set.deleted = 0;
+    set.capacity = capacity;
+    set.values = a->alloc<T>(capacity);
+    set.meta = a->alloc<Meta>(capacity);
+
+    memset(set.meta, OK_TAB_META_EMPTY, capacity);
+
+    return set;
+}
+
+template <typename T>
+template <typename Q>
+size_t Set<T>::find_index(const Q& elem, uint64_t hash) const {
+    uint8_t h2 = OK_TAB_H2(hash);
+
+    for (TableProbe probe{hash, capacity};; probe.next()) {
+        TableGroup group{meta + probe.offset()};
+
+        for (auto match = group.match(h2); match.any(); match.clear_lowest()) {
+            size_t idx = probe.offset() + match.lowest();
+            if (values[idx] == elem) return idx;
+        }
+
+        if (group.match_empty().any()) return (size_t)-1;
+    }
+}
+
+template <typename T>
+size_t Set<T>::find_free_index(uint64_t hash) const {
+    for (TableProbe probe{hash, capacity};; probe.next()) {
+        auto free = TableGroup{meta + probe.offset()}.match_free();
+        if (free.any()) return probe.offset() + free.lowest();
+    }
+}
+
+template <typename T>
+void Set<T>::resize(size_t new_capacity) {
+    auto new_set = Set<T>::alloc(allocator, new_capacity);
+
+    for (size_t i = 0; i < capacity; i++) {
+        if (OK_TAB_IS_FREE(meta[i])) continue;
+
+        uint64_t hash = Hash<T>::hash(values[i]);
+        size_t idx = new_set.find_free_index(hash);
+
+        new_set.meta[idx] = OK_TAB_H2(hash);
+        new_set.values[idx] = values[i];
+    }
+
+    new_set.count = count;
+
+    free();
+    *this = new_set;
+}
+
+template <typename T>
+void Set<T>::rehash() {
+    if (deleted == 0) return;
+
+    for (size_t i = 0; i < capacity; i++) {
+        meta[i] = OK_TAB_IS_OCCUPIED(meta[i]) ? OK_TAB_META_DELETED : OK_TAB_META_EMPTY;
+    }
+
+    size_t i = 0;
+
+    while (i < capacity) {
+        if (meta[i] != OK_TAB_META_DELETED) {
+            i++;
+            continue;
+        }
+
+        uint64_t hash = Hash<T>::hash(values[i]);
+        size_t target = find_free_index(hash);
+
+        if (target / TableGroup::WIDTH == i / TableGroup::WIDTH) {
+            meta[i] = OK_TAB_H2(hash);
+            i++;
+            continue;
+        }
+
+        if (meta[target] == OK_TAB_META_EMPTY) {
+            values[target] = values[i];
+            meta[target] = OK_TAB_H2(hash);
+            meta[i] = OK_TAB_META_EMPTY;
+            i++;
+            continue;
+        }
+
+        T value = values[target];
+        values[target] = values[i];
+        meta[target] = OK_TAB_H2(hash);
+        values[i] = value;
+    }
+
+    deleted = 0;
+}
+
+template <typename T>
+void Set<T>::reserve(size_t elements) {
+    size_t new_capacity = table_capacity_for(elements);
+    if (new_capacity > capacity) resize(new_capacity);
+}
+
+template <typename T>
+void Set<T>::free() {
+    allocator->dealloc(meta, capacity);
+    allocator->dealloc(values, capacity);
+}
+
+template <typename T>
+void Set<T>::put(const T& elem) {
+    uint64_t hash = Hash<T>::hash(elem);
+
+    if (find_index(elem, hash) != (size_t)-1) return;
+
+    if (count + deleted >= max_load()) {
+        if (count * 2 >= max_load()) resize(OK_SET_GROWTH_FACTOR(capacity));
+        else rehash();
+    }
+
+    size_t idx = find_free_index(hash);
+
+    if (meta[idx] == OK_TAB_META_DELETED) deleted--;
+
+    meta[idx] = OK_TAB_H2(hash);
+    values[idx] = elem;
+    count++;
+}
+
+template <typename T>
+template <typename Q>
+bool Set<T>::has(const Q& query) const {
+    const TableLookup<T, Q>& elem = query;
+    return find_index(elem, Hash<TableLookup<T, Q>>::hash(elem)) != (size_t)-1;
+}
+
+template <typename T>
+template <typename Q>
+bool Set<T>::remove(const Q& query) {
+    const TableLookup<T, Q>& elem = query;
+    size_t idx = find_index(elem, Hash<TableLookup<T, Q>>::hash(elem));
+    if (idx == (size_t)-1) return false;
+
+    meta[idx] = table_removed_meta(meta, idx);
+    if (meta[idx] == OK_TAB_META_DELETED) deleted++;
+
+    count--;
+    return true;
+}
+
+// QUEUE IMPLEMENTATION
+template <typename T>
+void SpscQueue<T>::init(SpscQueue<T>* out, Allocator* a, size_t capacity) {
+    capacity = round_up_pow2(capacity > 2 ? capacity : 2);
+
+    out->allocator = a;
+    out->items = a->alloc<T>(capacity);
+    out->mask = capacity - 1;
+    out->head.store(0, std::memory_order_relaxed);
+    out->cached_tail = 0;
+    out->tail.store(0, std::memory_order_relaxed);
+    out->cached_head = 0;
+}
+
+template <typename T>
+inline bool SpscQueue<T>::push(const T& item) {
+    T copy = item;
+    return push(std::move(copy));
+}
+
+template <typename T>
+bool SpscQueue<T>::push(T&& item) {
+    size_t t = tail.load(std::memory_order_relaxed);
+
+    if (t - cached_head > mask) {
+        cached_head = head.load(std::memory_order_acquire);
+        if (t - cached_head > mask) return false;
+    }
+
+    new ((void*)&items[t & mask]) T(std::move(item));
+    tail.store(t + 1, std::memory_order_release);
+
+    return true;
+}
+
+template <typename T>
+size_t SpscQueue<T>::push_n(Slice<T> batch) {
+    size_t t = tail.load(std::memory_order_relaxed);
+    size_t capacity = mask + 1;
+
+    if (capacity - (t - cached_head) < batch.count) cached_head = head.load(std::memory_order_acquire);
+
+    size_t free_count = capacity - (t - cached_head);
+    size_t n = batch.count < free_count ? batch.count : free_count;
+
+    for (size_t i = 0; i < n; i++) new ((void*)&items[(t + i) & mask]) T(batch.items[i]);
+    if (n > 0) tail.store(t + n, std::memory_order_release);
+
+    return n;
+}
+
+template <typename T>
+bool SpscQueue<T>::pop(T* out) {
+    size_t h = head.load(std::memory_order_relaxed);
+
+    if (h == cached_tail) {
+        cached_tail = tail.load(std::memory_order_acquire);
+        if (h == cached_tail) return false;
+    }
+
+    T* item = &items[h & mask];
+    *out = std::move(*item);
+    item->~T();
+    head.store(h + 1, std::memory_order_release);
+
+    return true;
+}
+
+template <typename T>
+Slice<T> SpscQueue<T>::pop_n(T* out, size_t max_count) {
+    size_t h = head.load(std::memory_order_relaxed);
+
+    if (cached_tail - h < max_count) cached_tail = tail.load(std::memory_order_acquire);
+
+    size_t available = cached_tail - h;
+    size_t n = max_count < available ? max_count : available;
+
+    for (size_t i = 0; i < n; i++) {
+        T* item = &items[(h + i) & mask];
+        out[i] = std::move(*item);
+        item->~T();
+    }
+
+    if (n > 0) head.store(h + n, std::memory_order_release);
+
+    return Slice<T>{out, n};
+}
+
+template <typename T>
+inline size_t SpscQueue<T>::count() const {
+    return tail.load(std::memory_order_acquire) - head.load(std::memory_order_acquire);
+}
+
+template <typename T>
+void SpscQueue<T>::free() {
+    size_t t = tail.load(std::memory_order_relaxed);
+
+    for (size_t h = head.load(std::memory_order_relaxed); h != t; h++) items[h & mask].~T();
+
+    allocator->dealloc(items, mask + 1);
+}
+
+template <typename T>
+void MpmcQueue<T>::init(MpmcQueue<T>* out, Allocator* a, size_t capacity) {
+    capacity = round_up_pow2(capacity > 2 ? capacity : 2);
+
+    out->allocator = a;
+    out->cells = a->alloc<Cell>(capacity);
+    out->mask = capacity - 1;
+    out->head.store(0, std::memory_order_relaxed);
+    out->tail.store(0, std::memory_order_relaxed);
+
+    // a cell is free for the producer at position p once its sequence is p
+    for (size_t i = 0; i < capacity; i++) new ((void*)&out->cells[i].sequence) std::atomic<size_t>(i);
+}
+
+template <typename T>
+inline bool MpmcQueue<T>::push(const T& item) {
+    T copy = item;
+    return push(std::move(copy));
+}
+
+template <typename T>
+bool MpmcQueue<T>::push(T&& item) {
+    size_t pos = tail.load(std::memory_order_relaxed);
+
+    while (true) {
+        Cell* cell = &cells[pos & mask];
+        size_t seq = cell->sequence.load(std::memory_order_acquire);
+        intptr_t diff = (intptr_t)seq - (intptr_t)pos;
+
+        if (diff == 0) {
+            if (tail.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                new ((void*)cell->value()) T(std::move(item));
+                cell->sequence.store(pos + 1, std::memory_order_release);
+                return true;
+            }
+        } else if (diff < 0) {
+            // the cell still holds an item from the previous lap
+            return false;
+        } else {
+            pos = tail.load(std::memory_order_relaxed);
+        }
+    }
+}
+
+template <typename T>
+size_t MpmcQueue<T>::push_n(Slice<T> batch) {
+    if (batch.count == 0) return 0;
+
+    size_t pos = tail.load(std::memory_order_relaxed);
+    size_t n;
+
+    while (true) {
+        // consumers free cells out of order, so only the leading run of free cells can be claimed
+        n = 0;
+        while (n < batch.count && n <= mask
+               && cells[(pos + n) & mask].sequence.load(std::memory_order_acquire) == pos + n) {
+            n++;
+        }
+
+        if (n == 0) {
+            intptr_t diff = (intptr_t)cells[pos & mask].sequence.load(std::memory_order_acquire) - (intptr_t)pos;
+            if (diff < 0) return 0;
+
+            pos = tail.load(std::memory_order_relaxed);
+            continue;
+        }
+
+        if (tail.compare_exchange_weak(pos, pos + n, std::memory_order_relaxed)) break;
+    }
+
+    for (size_t i = 0; i < n; i++) {
+        Cell* cell = &cells[(pos + i) & mask];
+        new ((void*)cell->value()) T(batch.items[i]);
+        cell->sequence.store(pos + i + 1, std::memory_order_release);
+    }
+
+    return n;
+}
+
+template <typename T>
+bool MpmcQueue<T>::pop(T* out) {
+    size_t pos = head.load(std::memory_order_relaxed);
+
+    while (true) {
+        Cell* cell = &cells[pos & mask];
+        size_t seq = cell->sequence.load(std::memory_order_acquire);
+        intptr_t diff = (intptr_t)seq - (intptr_t)(pos + 1);
+
+        if (diff == 0) {
+            if (head.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                T* item = cell->value();
+                *out = std::move(*item);
+                item->~T();
+
+                // free for the producer one lap later
+                cell->sequence.store(pos + mask + 1, std::memory_order_release);
+                return true;
+            }
+        } else if (diff < 0) {
+            return false;
+        } else {
+            pos = head.load(std::memory_order_relaxed);
+        }
+    }
+}
+
+template <typename T>
+Slice<T> MpmcQueue<T>::pop_n(T* out, size_t max_count) {
+    if (max_count == 0) return Slice<T>{out, 0};
+
+    size_t pos = head.load(std::memory_order_relaxed);
+    size_t n;
+
+    while (true) {
+        n = 0;
+        while (n < max_count && n <= mask
+               && cells[(pos + n) & mask].sequence.load(std::memory_order_acquire) == pos + n + 1) {
+            n++;
+        }
+
+        if (n == 0) {
+            intptr_t diff = (intptr_t)cells[pos & mask].sequence.load(std::memory_order_acquire) - (intptr_t)(pos + 1);
+            if (diff < 0) return Slice<T>{out, 0};
+
+            pos = head.load(std::memory_order_relaxed);
+            continue;
+        }
+
+        if (head.compare_exchange_weak(pos, pos + n, std::memory_order_relaxed)) break;
+    }
+
+    for (size_t i = 0; i < n; i++) {
+        Cell* cell = &cells[(pos + i) & mask];
+        T* item = cell->value();
+        out[i] = std::move(*item);
+        item->~T();
+        cell->sequence.store(pos + i + mask + 1, std::memory_order_release);
+    }
+
+    return Slice<T>{out, n};
+}
+
+template <typename T>
+inline size_t MpmcQueue<T>::count() const {
+    size_t h = head.load(std::memory_order_acquire);
+    size_t t = tail.load(std::memory_order_acquire);
+    return t > h ? t - h : 0;
+}
+
+template <typename T>
+void MpmcQueue<T>::free() {
+    size_t t = tail.load(std::memory_order_relaxed);
+
+    for (size_t h = head.load(std::memory_order_relaxed); h != t; h++) cells[h & mask].value()->~T();
+
+    allocator->dealloc(cells, mask + 1);
+}
+
+// filesystem API
+struct File {
+    enum class OpenError {
+        ACCESS_DENIED,
+        INVALID_PATH,
+        IS_DIRECTORY,
+        TOO_MANY_SYMLINKS,
+        PROCESS_OPEN_FILES_LIMIT_REACHED,
+        SYSTEM_OPEN_FILES_LIMIT_REACHED,
+        PATH_TOO_LONG,
+        KERNEL_OUT_OF_MEMORY,
+        OUT_OF_SPACE,
+        IS_SOCKET,
+        FILE_TOO_BIG,
+        READONLY_FILE,
+    };
+
+    enum class ReadError {
+        IO_ERROR,
+    };
+
+    enum class WriteError {
+        IO_ERROR,
+        OUT_OF_SPACE,
+        QUOTA_EXCEEDED,
+        FILE_TOO_BIG,
+        BROKEN_PIPE,
+    };
+
+    enum class MapError {
+        ACCESS_DENIED,
+        NOT_MAPPABLE,
+        OUT_OF_MEMORY,
+        FILE_TOO_BIG,
+    };
+
+    // Hints the OS about how a mapping is going to be read
+    enum class AccessPattern {
+        NORMAL,
+        SEQUENTIAL,
+        RANDOM,
+    };
+
+    // A read-only view of the file contents that stays valid until it is unmapped
+    struct Mapping {
+        inline Slice<uint8_t> bytes() const {
+            return Slice<uint8_t>{data, size};
+        }
+
+        inline StringView view() const {
+            return StringView{(const char*)data, size};
+        }
+
+        void unmap();
+
+        const uint8_t* data;
+        size_t size;
+    };
+
+    static Optional<OpenError> open(File* out, const char* path);
+    // Opens the file for reading and writing, creating or truncating it
+    static Optional<OpenError> create(File* out, const char* path);
+
+    void close();
+
+    void seek_start() const;
+    off_t seek_end() const;
+
+    // Reads up to `count` bytes, stopping early only at the end of the file
+    Optional<ReadError> read(uint8_t* buf, size_t count, size_t* bytes_read = nullptr);
+    // Reads whatever a single read call returns, 0 bytes means the end of the file
+    Optional<ReadError> read_some(uint8_t* buf, size_t count, size_t* bytes_read);
+
+    Optional<WriteError> write(const uint8_t* buf, size_t count);
+
+    inline Optional<WriteError> write(StringView sv) {
+        return write((const uint8_t*)sv.data, sv.count);
+    }
+
+    // Positional IO does not use or move the file offset, so it is safe to share a file between threads
+    Optional<ReadError> read_at(uint8_t* buf, size_t count, uint64_t offset, size_t* bytes_read = nullptr);
+    Optional<WriteError> write_at(const uint8_t* buf, size_t count, uint64_t offset);
+
+    // Scatter reads fill the unused capacity of each list in order and advance its count
+    Optional<ReadError> readv(Slice<List<uint8_t>*> buffers, size_t* bytes_read = nullptr);
+    Optional<ReadError> readv_at(Slice<List<uint8_t>*> buffers, uint64_t offset, size_t* bytes_read = nullptr);
+
+    Optional<WriteError> writev(Slice<Slice<uint8_t>> buffers);
+    Optional<WriteError> writev_at(Slice<Slice<uint8_t>> buffers, uint64_t offset);
+
+    Optional<ReadError> read_full(Allocator* a, List<uint8_t>* out);
+
+    // Maps the whole file into memory without copying it. Empty files produce an empty mapping.
+    Optional<MapError> map(Mapping* out, AccessPattern pattern = AccessPattern::NORMAL) const;
+
+    size_t size() const;
+
+    int fd;
+    const char* path;
+};
+
+// Reads a file in large chunks, handing out views into its buffer
+struct BufferedReader {
+    static constexpr size_t DEFAULT_BUFFER_SIZE = 64 * 1024;
+
+    static BufferedReader alloc(Allocator* a, File* file, size_t buffer_size = DEFAULT_BUFFER_SIZE);
+
+    // Reads more data after the buffered bytes, growing the buffer if it is full
+    Optional<File::ReadError> fill();
+
+    Optional<File::ReadError> read(uint8_t* buf, size_t count, size_t* bytes_read);
+
+    // `out` is set to the bytes up to the delimiter, or to nothing once the input is exhausted.
+    // The view points into the buffer and is only valid until the next read.
+    Optional<File::ReadError> read_until(char delim, Optional<StringView>* out);
+    // Same as read_until('\n') but also strips a trailing '\r'
+    Optional<File::ReadError> read_line(Optional<StringView>* out);
+
+    inline StringView buffered() const {
+        return StringView{(const char*)buffer + start, end - start};
+    }
+
+    inline void free() {
+        allocator->dealloc(buffer, capacity);
+    }
+
+    File* file;
+    Allocator* allocator;
+    uint8_t* buffer;
+    size_t capacity;
+    size_t start;
+    size_t end;
+    bool eof;
+};
+
+// Collects small writes and hands them to the file in buffer-sized chunks
+struct BufferedWriter {
+    static constexpr size_t DEFAULT_BUFFER_SIZE = 64 * 1024;
+
+    static BufferedWriter alloc(Allocator* a, File* file, size_t buffer_size = DEFAULT_BUFFER_SIZE);
+
+    Optional<File::WriteError> write(const uint8_t* data, size_t count);
+
+    inline Optional<File::WriteError> write(StringView sv) {
+        return write((const uint8_t*)sv.data, sv.count);
+    }
+
+    Optional<File::WriteError> flush();
+
+    // Does not flush the buffered data
+    inline void free() {
+        allocator->dealloc(buffer, capacity);
+    }
+
+    File* file;
+    Allocator* allocator;
+    uint8_t* buffer;
+    size_t capacity;
+    size_t count;
+};
+
+// Lists the entries of a directory a buffer at a time: getdents64 on Linux, readdir on other
+// UNIX-like systems and FindFirstFileEx with large fetches on Windows. Entry names point into
+// the iterator's buffer, so listing allocates nothing per entry
+struct DirectoryIterator {
+    enum class OpenError {
+        ACCESS_DENIED,
+        NOT_FOUND,
+        NOT_A_DIRECTORY,
+        TOO_MANY_SYMLINKS,
+        PROCESS_OPEN_FILES_LIMIT_REACHED,
+        SYSTEM_OPEN_FILES_LIMIT_REACHED,
+        PATH_TOO_LONG,
+        KERNEL_OUT_OF_MEMORY,
+        // anything else the OS reports, e.g. EIO or a filesystem that refuses the open
+        IO_ERROR,
+    };
+
+    enum class ReadError {
+        DIRECTORY_REMOVED,
+        IO_ERROR,
+    };
+
+    enum class StatError {
+        ACCESS_DENIED,
+        NOT_FOUND,
+        IO_ERROR,
+    };
+
+    // Some filesystems do not report the type while listing, stat tells those entries apart
+    enum class EntryType : uint8_t {
+        UNKNOWN,
+        FILE,
+        DIRECTORY,
+        SYMLINK,
+        OTHER,
+    };
+
+    struct Entry {
+        // Valid until the next call to next
+        StringView name;
+        EntryType type;
+    };
+
+    struct Info {
+        uint64_t size;
+        // seconds since the Unix epoch
+        int64_t modified_time;
+        EntryType type;
+    };
+
+    static constexpr size_t DEFAULT_BUFFER_SIZE = 32 * 1024;
+
+    static Optional<OpenError> open(DirectoryIterator* out, Allocator* a, const char* path,
+                                    size_t buffer_size = DEFAULT_BUFFER_SIZE);
+
+    // `out` is set to the next entry, or to nothing once the directory is exhausted. "." and ".." are skipped
+    Optional<ReadError> next(Optional<Entry>* out);
+
+    // Looks up the metadata of the entry last returned by next. Symlinks are not followed.
+    // UNIX-like systems resolve the name relative to the open directory, Windows already
+    // fetched it along with the name
+    Optional<StatError> stat(const Entry& entry, Info* out) const;
+
+    void close();
+
+    Allocator* allocator;
+    uint8_t* buffer;
+    size_t capacity;
+
+#if OK_LINUX
+    int fd;
+    size_t start;
+    size_t end;
+#elif OK_UNIX
+    DIR* dir;
+#elif OK_WINDOWS
+    HANDLE find;
+    WIN32_FIND_DATAA data;
+    // the first entry comes with FindFirstFileEx
+    bool pending;
+#endif // OK_LINUX
+};
+
+// Walks a directory tree on several threads. Directories are shared between the threads through
+// an MpmcQueue and each thread lists them with its own DirectoryIterator, so a tree with many
+// directories keeps every thread busy. Symlinks are reported but not followed.
+struct DirectoryWalker {
+    struct Entry {
+        // The root joined with the entry's name, valid only during the visit
+        StringView path;
+        StringView name;
+        DirectoryIterator::EntryType type;
+        // 0 for the entries of the root
+        size_t depth;
+    };
+
+    // Called concurrently from all the threads. Returning false for a directory skips its contents
+    using Visit = bool (*)(void* user_data, const Entry& entry);
+
+    static constexpr size_t QUEUE_CAPACITY = 4096;
+
+    // `thread_count` includes the calling thread, 0 uses one thread per core. Only failing to open
+    // the root is reported, subdirectories that cannot be opened or read are skipped.
+    static Optional<DirectoryIterator::OpenError> walk(const char* root, Visit visit, void* user_data,
+                                                       size_t thread_count = 0);
+
+    template <typename F>
+    static inline Optional<DirectoryIterator::OpenError> walk(const char* root, F&& visit, size_t thread_count = 0) {
+        using Callable = typename std::remove_reference<F>::type;
+
+        auto trampoline = [](void* user_data, const Entry& entry) -> bool {
+            return (*(Callable*)user_data)(entry);
+        };
+
+        return walk(root, trampoline, (void*)&visit, thread_count);
+    }
+};
+
+// Submits batches of reads and writes against files and collects their completions later.
+// Uses io_uring on Linux and IOCP on Windows. Everywhere else, or when the kernel lacks
+// io_uring, requests are carried out one after another when they are submitted.
+struct AsyncIo {
+    static constexpr uint32_t DEFAULT_ENTRIES = 256;
+
+    enum class Error {
+        OUT_OF_MEMORY,
+        SUBMIT_FAILED,
+        WAIT_FAILED,
+    };
+
+    enum class Backend : uint8_t {
+        BLOCKING,
+        IO_URING,
+        IOCP,
+    };
+
+    enum class Op : uint8_t {
+        READ,
+        WRITE,
+    };
+
+    struct Request {
+        Op op;
+        int fd;
+        uint8_t* buffer;
+        size_t count;
+        uint64_t offset;
+        uint64_t user_data;
+    };
+
+    // `result` is the number of bytes transferred, or a negated errno value
+    struct Completion {
+        uint64_t user_data;
+        int64_t result;
+    };
+
+#if OK_IO_URING
+    struct Ring {
+        int fd;
+        uint32_t* sq_head;
+        uint32_t* sq_tail;
+        uint32_t* sq_mask;
+        uint32_t* sq_array;
+        io_uring_sqe* sqes;
+        uint32_t* cq_head;
+        uint32_t* cq_tail;
+        uint32_t* cq_mask;
+        io_uring_cqe* cqes;
+        void* sq_mapping;
+        size_t sq_mapping_size;
+        void* cq_mapping;
+        size_t cq_mapping_size;
+        size_t sqes_size;
+    };
+#endif // OK_IO_URING
+
+#if OK_WINDOWS
+    struct Pending {
+        OVERLAPPED overlapped;
+        uint64_t user_data;
+        Pending* next_free;
+    };
+#endif // OK_WINDOWS
+
+    // `entries` bounds the number of requests that are queued or in flight at once
+    static Optional<Error> init(AsyncIo* out, Allocator* a, uint32_t entries = DEFAULT_ENTRIES);
+    void deinit();
+
+    // Both return false when `entries` requests are already queued or in flight
+    bool queue_read(const File& file, uint8_t* buf, size_t count, uint64_t offset, uint64_t user_data);
+    bool queue_write(const File& file, const uint8_t* buf, size_t count, uint64_t offset, uint64_t user_data);
+
+    Optional<Error> submit();
+    // Copies out up to `max` finished requests without blocking
+    size_t poll(Completion* out, size_t max);
+    // Blocks until at least `min_count` requests (but no more than `max`) have been copied out
+    Optional<Error> wait(Completion* out, size_t max, size_t min_count, size_t* count);
+
+    inline uint32_t pending() const {
+        return queued_count + unsubmitted + in_flight;
+    }
+
+    Allocator* allocator;
+    Backend backend;
+    uint32_t entries;
+    uint32_t in_flight;
+
+    Request* queued;
+    uint32_t queued_count;
+    // requests already written into the kernel's queue that it did not accept yet,
+    // left there by a failed submit for the next one to retry
+    uint32_t unsubmitted;
+
+    // completions that did not go through the kernel's queue
+    Completion* completed;
+    uint32_t completed_head;
+    uint32_t completed_count;
+
+#if OK_IO_URING
+    Ring ring;
+#elif OK_WINDOWS
+    HANDLE port;
+    Pending* pending_pool;
+    Pending* free_pending;
+    Table<int32_t, HANDLE> handles;
+#endif // OK_IO_URING
+};
+
+// An IPv4 or IPv6 socket address
+struct Address {
+    enum class ParseError {
+        INVALID_ADDRESS,
+    };
+
+    // Parses a numeric address such as "127.0.0.1" or "::1", no name resolution is done
+    static Optional<ParseError> parse(Address* out, const char* ip, uint16_t port);
+
+    static Address loopback(uint16_t port);
+    // The IPv4 wildcard address, for listening on every interface
+    static Address any(uint16_t port);
+
+    uint16_t port() const;
+
+    inline bool is_ipv6() const {
+        return storage.ss_family == AF_INET6;
+    }
+
+    sockaddr_storage storage;
+    uint32_t length;
+};
+
+// A non-blocking TCP or UDP socket. Calls that would block fail with Error::WOULD_BLOCK
+struct Socket {
+#if OK_WINDOWS
+    using Handle = SOCKET;
+    static constexpr Handle INVALID_HANDLE = INVALID_SOCKET;
+#else
+    using Handle = int;
+    static constexpr Handle INVALID_HANDLE = -1;
+#endif // OK_WINDOWS
+
+    enum class Type : uint8_t {
+        TCP,
+        UDP,
+    };
+
+    enum class Error {
+        WOULD_BLOCK,
+        ACCESS_DENIED,
+        ADDRESS_IN_USE,
+        ADDRESS_NOT_AVAILABLE,
+        CONNECTION_REFUSED,
+        CONNECTION_RESET,
+        CONNECTION_ABORTED,
+        NOT_CONNECTED,
+        BROKEN_PIPE,
+        TIMED_OUT,
+        NETWORK_UNREACHABLE,
+        HOST_UNREACHABLE,
+        TOO_MANY_OPEN_FILES,
+        OUT_OF_MEMORY,
+        MESSAGE_TOO_BIG,
+        IO_ERROR,
+    };
+
+    static Optional<Error> open(Socket* out, bool ipv6, Type type);
+    // Opens a socket bound to `address`. TCP sockets are also put into the listening state
+    static Optional<Error> listen(Socket* out, const Address& address, Type type = Type::TCP, int backlog = 128);
+    // Starts connecting to `address`. The connection is established once the socket becomes
+    // writable, `connect_result()` then tells whether it succeeded
+    static Optional<Error> connect(Socket* out, const Address& address, Type type = Type::TCP);
+
+    Optional<Error> connect_result() const;
+    Optional<Error> accept(Socket* out, Address* peer = nullptr) const;
+
+    // A successful read of 0 bytes means the peer has closed the connection
+    Optional<Error> read(uint8_t* buf, size_t count, size_t* bytes_read) const;
+    Optional<Error> write(const uint8_t* buf, size_t count, size_t* bytes_written) const;
+
+    inline Optional<Error> write(StringView sv, size_t* bytes_written) const {
+        return write((const uint8_t*)sv.data, sv.count, bytes_written);
+    }
+
+    Optional<Error> recv_from(uint8_t* buf, size_t count, Address* from, size_t* bytes_read) const;
+    Optional<Error> send_to(const uint8_t* buf, size_t count, const Address& to, size_t* bytes_written) const;
+
+    Optional<Error> local_address(Address* out) const;
+    Optional<Error> set_nodelay(bool enabled) const;
+
+    void close();
+
+    Handle handle;
+};
+
+// Waits for readiness on many sockets at once. epoll and kqueue report edge-triggered events,
+// WSAPoll on Windows is level-triggered, so handlers should read and write until WOULD_BLOCK
+// to behave the same everywhere.
+struct EventLoop {
+    static constexpr size_t MAX_EVENTS_PER_WAIT = 64;
+
+    enum class Error {
+        TOO_MANY_OPEN_FILES,
+        OUT_OF_MEMORY,
+        ALREADY_REGISTERED,
+        NOT_REGISTERED,
+        // the handle is open but cannot be polled, e.g. a regular file under epoll
+        UNSUPPORTED_HANDLE,
+        // the handle is closed or is the loop itself
+        INVALID_HANDLE,
+        WAIT_FAILED,
+    };
+
+    // interest and event flags
+    enum : uint8_t {
+        READABLE = 1 << 0,
+        WRITABLE = 1 << 1,
+        HANGUP   = 1 << 2,
+        ERRORED  = 1 << 3,
+    };
+
+    struct Event {
+        void* user_data;
+        uint8_t flags;
+    };
+
+    static Optional<Error> init(EventLoop* out, Allocator* a);
+    void deinit();
+
+    Optional<Error> add(const Socket& socket, uint8_t interest, void* user_data);
+    Optional<Error> modify(const Socket& socket, uint8_t interest, void* user_data);
+    void remove(const Socket& socket);
+
+    // Waits up to `timeout_ms` milliseconds for events, a negative timeout waits forever
+    Optional<Error> wait(Event* out, size_t max, int timeout_ms, size_t* count);
+
+    Allocator* allocator;
+
+#if OK_WINDOWS || (!OK_LINUX && !OK_KQUEUE)
+#if OK_WINDOWS
+    using PollFd = WSAPOLLFD;
+#else
+    using PollFd = pollfd;
+#endif // OK_WINDOWS
+    List<PollFd> fds;
+    List<void*> user_datas;
+#else
+    int fd;
+#endif // OK_WINDOWS || (!OK_LINUX && !OK_KQUEUE)
+};
+
+// A socket together with the arena its received bytes live in. Everything a connection allocates
+// from `arena` is dropped at once by `reset()`, ready for the next request on the same socket.
+struct Connection {
+    static constexpr size_t DEFAULT_READ_SIZE = 16 * 1024;
+
+    static void init(Connection* out, Socket socket);
+
+    // Reads until the socket would block, appending to the received bytes.
+    // `peer_closed` is set once the other side has shut down its end
+    Optional<Socket::Error> receive();
+
+    // Drops `count` bytes from the front of the received data
+    void consume(size_t count);
+
+    inline Slice<uint8_t> data() const {
+        return Slice<uint8_t>{buffer + start, count - start};
+    }
+
+    inline StringView view() const {
+        return StringView{(const char*)buffer + start, count - start};
+    }
+
+    inline void reset() {
+        arena.reset();
+        buffer = nullptr;
+        start = 0;
+        count = 0;
+        capacity = 0;
+    }
+
+    inline void close() {
+        socket.close();
+        arena.free();
+        buffer = nullptr;
+        start = 0;
+        count = 0;
+        capacity = 0;
+    }
+
+    Socket socket;
+    ArenaAllocator arena;
+    uint8_t* buffer;
+    size_t start;
+    size_t count;
+    size_t capacity;
+    bool peer_closed;
+};
+
+// procedures
+template <typename T>
+const T& max(const T& a) {
+    return a;
+}
+
+template <typename T, typename... Rest>
+const T& max(const T& x, const Rest&... xs) {
+    const T& xs_max = max(xs...);
+    return x > xs_max ? x : xs_max;
+}
+
+template <typename T>
+const T& min(const T& a) {
+    return a;
+}
+
+template <typename T, typename... Rest>
+const T& min(const T& x, const Rest&... xs) {
+    const T& xs_min = min(xs...);
+    return x < xs_min ? x : xs_min;
+}
+
+// Lines printed to stdout are collected in a per-thread buffer and written out with a single
+// write once it fills up, when a line is printed output_flush_interval_ns after the last flush,
+// on flush_output(), on a failed assertion or panic and when the thread exits. Once the buffer
+// is gone, e.g. in static destructors, lines are written right away. Lines printed to stderr are written right away,
+// after flushing the thread's stdout lines so that the two stay in order. None of this goes
+// through stdio, so output from printf is not ordered with it.
+static constexpr size_t OUTPUT_BUFFER_SIZE = 64 * 1024;
+static constexpr uint64_t OUTPUT_FLUSH_INTERVAL_NS = 100'000'000;
+
+// Starts out as OUTPUT_FLUSH_INTERVAL_NS, change it before other threads start printing
+extern uint64_t output_flush_interval_ns;
+
+void println(const char*);
+void println(StringView);
+void println(const String&);
+
+void eprintln(const char*);
+void eprintln(const String&);
+void eprintln(StringView);
+
+// Writes out the lines the calling thread has printed to stdout so far
+void flush_output();
+
+String to_string(Allocator*, int32_t);
+String to_string(Allocator*, uint32_t);
+String to_string(Allocator*, int64_t);
+String to_string(Allocator*, uint64_t);
+String to_string(Allocator*, double);
+
+// Buffers passed to to_chars need room for this many chars, no null terminator is written
+static constexpr size_t MAX_INT_CHARS = 20;
+static constexpr size_t MAX_DOUBLE_CHARS = 32;
+
+// Write the decimal representation of `value` into `buf` and return the number of chars written
+size_t to_chars(char* buf, uint64_t value);
+size_t to_chars(char* buf, int64_t value);
+size_t to_chars(char* buf, uint32_t value);
+size_t to_chars(char* buf, int32_t value);
+// The shortest representation that parses back to the same double, always with a '.' whatever the
+// locale. Without OK_FLOAT_CHARCONV this is a loop of up to three snprintf and strtod rounds at
+// increasing precision, not a dedicated shortest-digits algorithm
+size_t to_chars(char* buf, double value);
+
+// The parsers reject empty input, stray characters and values that do not fit.
+// parse_double expects a '.' as the decimal point regardless of the locale
+bool parse_int64(StringView, int64_t*);
+bool parse_uint64(StringView, uint64_t*);
+bool parse_double(StringView, double*);
+
+// formatting
+// Where formatted text goes, formatters may call `write` any number of times
+struct FormatSink {
+    virtual void write(StringView sv) = 0;
+};
+
+struct StringFormatSink : public FormatSink {
+    explicit StringFormatSink(String* out) : out{out} {}
+
+    void write(StringView sv) override {
+        out->append(sv);
+    }
+
+    String* out;
+};
+
+// Stops writing after the first error, which is kept in `error`
+struct WriterFormatSink : public FormatSink {
+    explicit WriterFormatSink(BufferedWriter* out) : out{out} {}
+
+    void write(StringView sv) override {
+        if (!error.has_value()) error = out->write(sv);
+    }
+
+    BufferedWriter* out;
+    Optional<File::WriteError> error;
+};
+
+// Formats a value for a `{}` placeholder. Specialize it to make other types formattable
+template <typename T, typename Enable = void>
+struct Formatter {};
+
+template <typename T>
+struct Formatter<T, typename std::enable_if<std::is_integral<T>::value && std::is_signed<T>::value>::type> {
+    static void format(FormatSink* sink, T value) {
+        char buf[MAX_INT_CHARS];
+        sink->write(StringView{buf, to_chars(buf, (int64_t)value)});
+    }
+};
+
+template <typename T>
+struct Formatter<T, typename std::enable_if<std::is_integral<T>::value && std::is_unsigned<T>::value>::type> {
+    static void format(FormatSink* sink, T value) {
+        char buf[MAX_INT_CHARS];
+        sink->write(StringView{buf, to_chars(buf, (uint64_t)value)});
+    }
+};
+
+template <typename T>
+struct Formatter<T, typename std::enable_if<std::is_floating_point<T>::value>::type> {
+    static void format(FormatSink* sink, T value) {
+        char buf[MAX_DOUBLE_CHARS];
+        sink->write(StringView{buf, to_chars(buf, (double)value)});
+    }
+};
+
+template <>
+struct Formatter<bool> {
+    static void format(FormatSink* sink, bool value) {
+        sink->write(value ? "true"_sv : "false"_sv);
+    }
+};
+
+template <>
+struct Formatter<char> {
+    static void format(FormatSink* sink, char value) {
+        sink->write(StringView{&value, 1});
+    }
+};
+
+template <>
+struct Formatter<StringView> {
+    static void format(FormatSink* sink, StringView value) {
+        sink->write(value);
+    }
+};
+
+template <>
+struct Formatter<String> {
+    static void format(FormatSink* sink, const String& value) {
+        sink->write(value.view());
+    }
+};
+
+template <>
+struct Formatter<const char*> {
+    static void format(FormatSink* sink, const char* value) {
+        sink->write(StringView{value});
+    }
+};
+
+template <>
+struct Formatter<char*> {
+    static void format(FormatSink* sink, const char* value) {
+        sink->write(StringView{value});
+    }
+};
+
+// A literal passed directly, up to its null terminator
+template <size_t N>
+struct Formatter<char[N]> {
+    static void format(FormatSink* sink, const char (&value)[N]) {
+        size_t count = 0;
+        while (count < N && value[count] != '\0') count++;
+        sink->write(StringView{value, count});
+    }
+};
+
+// Other pointers are printed as hexadecimal addresses
+template <typename T>
+struct Formatter<T*> {
+    static void format(FormatSink* sink, const T* value) {
+        char buf[2 + sizeof(uintptr_t) * 2];
+        uintptr_t address = (uintptr_t)value;
+        size_t idx = sizeof(buf);
+
+        do {
+            buf[--idx] = "0123456789abcdef"[address & 0xF];
+            address >>= 4;
+        } while (address != 0);
+
+        buf[--idx] = 'x';
+        buf[--idx] = '0';
+        sink->write(StringView{buf + idx, sizeof(buf) - idx});
+    }
+};
+
+// Reached when a format string does not match its arguments. Under C++20 the check runs
+// at compile time and calling this fails the build, earlier standards panic at runtime
+inline void _format_string_error(const char* message) {
+    OK_PANIC_FMT("Invalid format string: %s", message);
+}
+
+// A format string with `{}` placeholders, `{{` and `}}` stand for literal braces
+template <typename... Args>
+struct FormatString {
+    template <size_t N>
+    OK_CONSTEVAL FormatString(const char (&str)[N]) : view{str, N - 1} {
+        size_t placeholders = 0;
+
+        for (size_t i = 0; i < N - 1; i++) {
+            bool has_next = i + 1 < N - 1;
+
+            if (str[i] == '{') {
+                if (has_next && str[i + 1] == '{') {
+                    i++;
+                } else if (has_next && str[i + 1] == '}') {
+                    placeholders++;
+                    i++;
+                } else {
+                    _format_string_error("'{' has to be followed by '}' or '{'");
+                }
+            } else if (str[i] == '}') {
+                if (has_next && str[i + 1] == '}') i++;
+                else _format_string_error("unmatched '}'");
+            }
+        }
+
+        if (placeholders != sizeof...(Args)) _format_string_error("the number of placeholders and arguments differ");
+    }
+
+    StringView view;
+};
+
+template <typename T>
+struct _NoDeduce {
+    using type = T;
+};
+
+struct _FormatArg {
+    void (*format)(FormatSink*, const void*);
+    const void* value;
+};
+
+template <typename T>
+static void _format_erased(FormatSink* sink, const void* value) {
+    Formatter<T>::format(sink, *(const T*)value);
+}
+
+// Copies the literal parts of `fmt` and formats the arguments in between, in one pass
+inline void _format_args(FormatSink* sink, StringView fmt, const _FormatArg* args) {
+    size_t literal_start = 0;
+    size_t arg_idx = 0;
+
+    for (size_t i = 0; i < fmt.count; i++) {
+        char c = fmt.data[i];
+        if (c != '{' && c != '}') continue;
+
+        if (i > literal_start) sink->write(fmt.view(literal_start, i));
+
+        if (c == '{' && fmt.data[i + 1] == '}') {
+            const _FormatArg& arg = args[arg_idx++];
+            arg.format(sink, arg.value);
+        } else {
+            // an escaped brace, the second one starts the next literal
+            sink->write(StringView{&fmt.data[i], 1});
+        }
+
+        i++;
+        literal_start = i + 1;
+    }
+
+    if (literal_start < fmt.count) sink->write(fmt.view(literal_start));
+}
+
+template <typename... Args>
+inline void format_to(FormatSink* sink, FormatString<typename _NoDeduce<Args>::type...> fmt, const Args&... args) {
+    // one extra entry so that the array is never empty
+    const _FormatArg erased[] = {_FormatArg{&_format_erased<Args>, (const void*)&args}..., _FormatArg{nullptr, nullptr}};
+    _format_args(sink, fmt.view, erased);
+}
+
+template <typename... Args>
+inline void format_to(String* out, FormatString<typename _NoDeduce<Args>::type...> fmt, const Args&... args) {
+    StringFormatSink sink{out};
+    format_to<Args...>(&sink, fmt, args...);
+}
+
+template <typename... Args>
+inline Optional<File::WriteError> format_to(BufferedWriter* out, FormatString<typename _NoDeduce<Args>::type...> fmt, const Args&... args) {
+    WriterFormatSink sink{out};
+    format_to<Args...>(&sink, fmt, args...);
+    return sink.error;
+}
+
+template <typename... Args>
+inline String format(Allocator* a, FormatString<typename _NoDeduce<Args>::type...> fmt, const Args&... args) {
+    String s = String::alloc(a);
+    format_to<Args...>(&s, fmt, args...);
+    return s;
+}
+
+#ifdef OK_IMPLEMENTATION
+
+struct _ThreadTempAllocator final : public FixedBufferAllocator {
+    ~_ThreadTempAllocator() {
+        free();
+    }
+};
+
+thread_local _ThreadTempAllocator _temp_allocator_impl{};
+thread_local Allocator* temp_allocator = &_temp_allocator_impl;
+
+ConcurrentArenaAllocator _static_allocator_impl{};
+Allocator* static_allocator = &_static_allocator_impl;
+
+static void _init_region(ArenaAllocator::Region* region, size_t size) {
+    region->data = (uint8_t*)OK_ALLOC_PAGE(size);
+    OK_ASSERT(region->data != (void*)-1);
+    region->size = size;
+    region->off = 0;
+    region->next = nullptr;
+}
+
+// ALLOCATORS IMPLEMENTATION
+void* FixedBufferAllocator::raw_alloc(size_t size) {
+    size_t requested = size;
+    OK_UNUSED(requested);
+    size = align_to(size, sizeof(void*));
+
+    if (buffer == nullptr) {
+        buffer_size = max(size, OK_PAGE_SIZE * FixedBufferAllocator::DEFAULT_PAGE_COUNT);
+        buffer_size = align_to(buffer_size, OK_PAGE_ALIGN);
+        buffer = OK_ALLOC_PAGE(buffer_size);
+        buffer_off = 0;
+        OK_ALLOCATOR_STAT(on_region(buffer_size));
+    }
+
+    if (size > buffer_size) return nullptr;
+
+    if (buffer_size - buffer_off < size) {
+        switch (on_full) {
+        case FullPolicy::WRAP:
+            break;
+        case FullPolicy::REPORT:
+            fprintf(stderr, "FixedBufferAllocator: wrapped around after %zu bytes to fit %zu more\n", buffer_off, size);
+            break;
+        case FullPolicy::FAIL:
+            return nullptr;
+        case FullPolicy::PANIC:
+            OK_PANIC_FMT("FixedBufferAllocator: out of space, %zu bytes requested and %zu left", size, buffer_size - buffer_off);
+        }
+
+        wrap_count++;
+        buffer_off = size;
+        OK_ALLOCATOR_STAT(on_alloc(requested, size));
+        return buffer;
+    }
+
+    auto* ptr = (uint8_t*)buffer + buffer_off;
+    buffer_off += size;
+    OK_ALLOCATOR_STAT(on_alloc(requested, size));
+    return (void*)ptr;
+}
+
+void FixedBufferAllocator::raw_dealloc(void* ptr, size_t size) {
+    OK_ALLOCATOR_STAT(on_dealloc(size));
+    if (ptr == (void*)((uint8_t*)buffer + buffer_off)) buffer_off -= size;
+}
+
+ArenaAllocator::Region* ArenaAllocator::alloc_region(size_t region_size) {
+    using Region = ArenaAllocator::Region;
+
+    region_size = align_to(region_size, OK_PAGE_ALIGN);
+
+    Region* current_region = region_pool;
+
+    while (current_region) {
+        if (current_region->size - current_region->off >= sizeof(Region)) {
+            auto* region = (Region*)((uint8_t*)current_region->data + current_region->off);
+
+            _init_region(region, region_size);
+
+            current_region->off += align_to(sizeof(Region), sizeof(void*));
+
+            return region;
+        }
+
+        current_region = current_region->next;
+    }
+
+    current_region = (Region*)OK_ALLOC_SMOL(sizeof(Region));
+
+    current_region->data = OK_ALLOC_PAGE(OK_PAGE_SIZE);
+    current_region->size = OK_PAGE_SIZE;
+    current_region->off = align_to(sizeof(Region), sizeof(void*));
+    current_region->next = region_pool;
+
+    this->region_pool = current_region;
+
+    auto* resulting_region = (Region*)current_region->data;
+    _init_region(resulting_region, region_size);
+    return resulting_region;
+}
+
+ArenaAllocator::Region* ArenaAllocator::next_region(size_t size) {
+    if (current != nullptr && current->next != nullptr && current->next->avail() >= size) {
+        current = current->next;
+        return current;
+    }
+
+    size_t region_size = current != nullptr ? current->size * 2 : ArenaAllocator::DEFAULT_REGION_SIZE;
+    region_size = max(min(region_size, ArenaAllocator::MAX_REGION_SIZE), size);
+
+    Region* region = alloc_region(region_size);
+    OK_ALLOCATOR_STAT(on_region(region->size));
+
+    if (current == nullptr) {
+        region->next = head;
+        head = region;
+    } else {
+        region->next = current->next;
+        current->next = region;
+    }
+
+    current = region;
+    return region;
+}
+
+Allocator::Marker ArenaAllocator::mark() {
+    if (current == nullptr) return Marker{nullptr, 0};
+    return Marker{current, current->off};
+}
+
+void ArenaAllocator::restore(Marker marker) {
+    auto* region = (Region*)marker.region;
+
+    if (region == nullptr) {
+        if (head == nullptr) return;
+        region = head;
+    }
+
+    // every region between the marked one and the cursor was filled after the mark
+    for (Region* r = region; r != current;) {
+        r = r->next;
+        r->off = 0;
+    }
+
+    region->off = marker.off;
+    current = region;
+}
+
+static ConcurrentArenaAllocator::Region* _alloc_concurrent_region(size_t size) {
+    using Region = ConcurrentArenaAllocator::Region;
+
+    size_t mapping_size = align_to(size + ConcurrentArenaAllocator::HEADER_SIZE, OK_PAGE_ALIGN);
+
+    auto* region = (Region*)OK_ALLOC_PAGE(mapping_size);
+    OK_ASSERT(region != nullptr && region != (void*)-1);
+
+    region->next = nullptr;
+    region->size = mapping_size - ConcurrentArenaAllocator::HEADER_SIZE;
+    region->off.store(0, std::memory_order_relaxed);
+    return region;
+}
+
+static inline void _dealloc_concurrent_region(ConcurrentArenaAllocator::Region* region) {
+    OK_DEALLOC_PAGE((void*)region, region->size + ConcurrentArenaAllocator::HEADER_SIZE);
+}
+
+void* ConcurrentArenaAllocator::raw_alloc(size_t size) {
+    size = align_to(size, sizeof(void*));
+
+    while (true) {
+        Region* region = head.load(std::memory_order_acquire);
+
+        if (region != nullptr) {
+            size_t off = region->off.load(std::memory_order_relaxed);
+
+            while (region->size - off >= size) {
+                if (region->off.compare_exchange_weak(off, off + size, std::memory_order_relaxed)) {
+                    return region->data() + off;
+                }
+            }
+        }
+
+        size_t region_size = region != nullptr ? region->size * 2 : DEFAULT_REGION_SIZE;
+        region_size = max(min(region_size, MAX_REGION_SIZE), size);
+
+        Region* fresh = _alloc_concurrent_region(region_size);
+        fresh->off.store(size, std::memory_order_relaxed);
+        fresh->next = region;
+
+        if (head.compare_exchange_strong(region, fresh, std::memory_order_release, std::memory_order_relaxed)) {
+            return fresh->data();
+        }
+
+        // another thread installed a region first, so retry in that one
+        _dealloc_concurrent_region(fresh);
+    }
+}
+
+void ConcurrentArenaAllocator::raw_dealloc(void* ptr, size_t size) {
+    Region* region = head.load(std::memory_order_acquire);
+    if (region == nullptr) return;
+
+    size = align_to(size, sizeof(void*));
+
+    size_t end = (uint8_t*)ptr + size - region->data();
+    if ((uint8_t*)ptr < region->data() || end > region->size) return;
+
+    region->off.compare_exchange_strong(end, end - size, std::memory_order_relaxed);
+}
+
+void* ConcurrentArenaAllocator::raw_resize(void* old_ptr, size_t old_size, size_t new_size) {
+    Region* region = head.load(std::memory_order_acquire);
+    auto* ptr = (uint8_t*)old_ptr;
+
+    if (region != nullptr && ptr >= region->data() && ptr < region->data() + region->size) {
+        size_t start = ptr - region->data();
+        size_t end = start + align_to(old_size, sizeof(void*));
+        size_t new_end = start + align_to(new_size, sizeof(void*));
+
+        // only succeeds if the block is still the last allocation in the region
+        if (new_end <= region->size &&
+            region->off.compare_exchange_strong(end, new_end, std::memory_order_relaxed)) {
+            return old_ptr;
+        }
+    }
+
+    void* new_ptr = raw_alloc(new_size);
+    memcpy(new_ptr, old_ptr, min(old_size, new_size));
+    return new_ptr;
+}
+
+Allocator::Marker ConcurrentArenaAllocator::mark() {
+    Region* region = head.load(std::memory_order_acquire);
+    if (region == nullptr) return Marker{nullptr, 0};
+
+    return Marker{region, region->off.load(std::memory_order_relaxed)};
+}
+
+void ConcurrentArenaAllocator::restore(Marker marker) {
+    Region* region = head.load(std::memory_order_acquire);
+
+    while (region != nullptr && region != marker.region) {
+        Region* next = region->next;
+        _dealloc_concurrent_region(region);
+        region = next;
+    }
+
+    if (region != nullptr) region->off.store(marker.off, std::memory_order_relaxed);
+    head.store(region, std::memory_order_release);
+}
+
+void ConcurrentArenaAllocator::reset() {
+    Region* region = head.load(std::memory_order_acquire);
+    if (region == nullptr) return;
+
+    Region* older = region->next;
+
+    while (older != nullptr) {
+        Region* next = older->next;
+        _dealloc_concurrent_region(older);
+        older = next;
+    }
+
+    region->next = nullptr;
+    region->off.store(0, std::memory_order_relaxed);
+}
+
+void ConcurrentArenaAllocator::free() {
+    restore(Marker{nullptr, 0});
+}
+
+void PoolAllocator::refill(size_t size_class) {
+    auto* chunk = (Chunk*)OK_ALLOC_PAGE(CHUNK_SIZE);
+    OK_ASSERT(chunk != nullptr && chunk != (void*)-1);
+
+    chunk->size = CHUNK_SIZE;
+    chunk->next = chunks;
+    chunks = chunk;
+    OK_ALLOCATOR_STAT(on_region(CHUNK_SIZE));
+
+    size_t size = block_size(size_class);
+    uint8_t* start = (uint8_t*)chunk + align_to(sizeof(Chunk), MIN_BLOCK_SIZE);
+    uint8_t* end = (uint8_t*)chunk + CHUNK_SIZE;
+
+    Block* list = free_lists[size_class];
+
+    for (uint8_t* p = start; p + size <= end; p += size) {
+        auto* block = (Block*)p;
+        block->next = list;
+        list = block;
+    }
+
+    free_lists[size_class] = list;
+}
+
+void* PoolAllocator::raw_alloc(size_t size) {
+    if (size > MAX_BLOCK_SIZE) {
+        void* ptr = OK_ALLOC_PAGE(align_to(size, OK_PAGE_SIZE));
+        if (ptr == (void*)-1) return nullptr;
+        OK_ALLOCATOR_STAT(on_region(align_to(size, OK_PAGE_SIZE)));
+        OK_ALLOCATOR_STAT(on_alloc(size, align_to(size, OK_PAGE_SIZE)));
+        return ptr;
+    }
+
+    size_t sc = size_class(size);
+
+    if (free_lists[sc] == nullptr) refill(sc);
+    OK_ALLOCATOR_STAT(on_alloc(size, block_size(sc)));
+
+    Block* block = free_lists[sc];
+    free_lists[sc] = block->next;
+    return (void*)block;
+}
+
+void PoolAllocator::raw_dealloc(void* ptr, size_t size) {
+    if (ptr == nullptr) return;
+
+    OK_ALLOCATOR_STAT(on_dealloc(size));
+
+    if (size > MAX_BLOCK_SIZE) {
+        OK_DEALLOC_PAGE(ptr, align_to(size, OK_PAGE_SIZE));
+        OK_ALLOCATOR_STAT(on_region_release(align_to(size, OK_PAGE_SIZE)));
+        return;
+    }
+
+    size_t sc = size_class(size);
+
+    auto* block = (Block*)ptr;
+    block->next = free_lists[sc];
+    free_lists[sc] = block;
+}
+
+void* PoolAllocator::raw_resize(void* ptr, size_t old_size, size_t new_size) {
+    // there is no block yet, e.g. a list that was freed and is being pushed to again
+    if (ptr == nullptr || old_size == 0) {
+        if (ptr != nullptr) raw_dealloc(ptr, old_size);
+        return raw_alloc(new_size);
+    }
+
+    bool in_place = false;
+
+    if (old_size <= MAX_BLOCK_SIZE && new_size <= MAX_BLOCK_SIZE) {
+        in_place = size_class(old_size) == size_class(new_size);
+    } else if (old_size > MAX_BLOCK_SIZE && new_size > MAX_BLOCK_SIZE) {
+        in_place = align_to(old_size, OK_PAGE_SIZE) == align_to(new_size, OK_PAGE_SIZE);
+    }
+
+    if (in_place) {
+        OK_ALLOCATOR_STAT(on_resize(old_size, new_size));
+        return ptr;
+    }
+
+    void* new_ptr = raw_alloc(new_size);
+    memcpy(new_ptr, ptr, min(old_size, new_size));
+    raw_dealloc(ptr, old_size);
+    return new_ptr;
+}
+
+void PoolAllocator::free() {
+    Chunk* chunk = chunks;
+
+    while (chunk != nullptr) {
+        Chunk* next = chunk->next;
+        OK_ALLOCATOR_STAT(on_region_release(chunk->size));
+        OK_DEALLOC_PAGE((void*)chunk, chunk->size);
+        chunk = next;
+    }
+
+    chunks = nullptr;
+    for (size_t i = 0; i < SIZE_CLASS_COUNT; i++) free_lists[i] = nullptr;
+}
+
+Optional<VirtualArenaAllocator::Error> VirtualArenaAllocator::init(VirtualArenaAllocator* out, size_t reserve_size,
+                                                                    bool huge_pages) {
+    size_t granularity = huge_pages ? HUGE_PAGE_SIZE : COMMIT_GRANULARITY;
+    reserve_size = align_to(reserve_size, granularity);
+
+    // huge pages need `base` aligned to their size, so there is room reserved to slide it
+    size_t mapping_size = huge_pages ? reserve_size + HUGE_PAGE_SIZE : reserve_size;
+
+#if OK_UNIX
+    int flags = MAP_PRIVATE | MAP_ANON;
+#ifdef MAP_NORESERVE
+    flags |= MAP_NORESERVE;
+#endif // MAP_NORESERVE
+
+    void* mapping = ::mmap(nullptr, mapping_size, PROT_NONE, flags, -1, 0);
+    if (mapping == MAP_FAILED) return Error::RESERVE_FAILED;
+#elif OK_WINDOWS
+    // large pages cannot be committed on demand
+    huge_pages = false;
+    mapping_size = reserve_size;
+
+    void* mapping = ::VirtualAlloc(nullptr, mapping_size, MEM_RESERVE, PAGE_NOACCESS);
+    if (mapping == nullptr) return Error::RESERVE_FAILED;
+#endif // OK_UNIX
+
+    out->mapping = mapping;
+    out->mapping_size = mapping_size;
+    out->base = (uint8_t*)(huge_pages ? align_to((uintptr_t)mapping, HUGE_PAGE_SIZE) : (uintptr_t)mapping);
+    out->reserved = reserve_size;
+    out->committed = 0;
+    out->off = 0;
+    out->granularity = granularity;
+    out->huge_pages = huge_pages;
+
+    return {};
+}
+
+bool VirtualArenaAllocator::commit(size_t size) {
+    if (size <= committed) return true;
+    if (size > reserved) return false;
+
+    size_t new_committed = min(align_to(size, granularity), reserved);
+    uint8_t* start = base + committed;
+    size_t grow = new_committed - committed;
+
+#if OK_UNIX
+    if (::mprotect(start, grow, PROT_READ | PROT_WRITE) != 0) return false;
+#if defined(MADV_HUGEPAGE)
+    if (huge_pages) ::madvise(start, grow, MADV_HUGEPAGE);
+#endif // MADV_HUGEPAGE
+#elif OK_WINDOWS
+    if (::VirtualAlloc(start, grow, MEM_COMMIT, PAGE_READWRITE) == nullptr) return false;
+#endif // OK_UNIX
+
+    OK_ALLOCATOR_STAT(on_commit(grow));
+    committed = new_committed;
+    return true;
+}
+
+void* VirtualArenaAllocator::commit_and_alloc(size_t size) {
+    if (base == nullptr) {
+        auto err = init(this);
+        OK_ASSERT(!err.has_value());
+    }
+
+    size_t aligned = align_to(size, sizeof(void*));
+    if (aligned > reserved - off || !commit(off + aligned)) return nullptr;
+
+    void* ptr = base + off;
+    off += aligned;
+
+    OK_ALLOCATOR_STAT(on_alloc(size, aligned));
+    return ptr;
+}
+
+void VirtualArenaAllocator::raw_dealloc(void* ptr, size_t size) {
+    OK_ALLOCATOR_STAT(on_dealloc(size));
+
+    size = align_to(size, sizeof(void*));
+    if ((uint8_t*)ptr + size == base + off) off -= size;
+}
+
+void* VirtualArenaAllocator::raw_resize(void* old_ptr, size_t old_size, size_t new_size) {
+    auto* ptr = (uint8_t*)old_ptr;
+    size_t aligned_old_size = align_to(old_size, sizeof(void*));
+
+    // the last block only has to move the bump pointer
+    if (ptr != nullptr && ptr + aligned_old_size == base + off) {
+        size_t start = ptr - base;
+        size_t aligned_new_size = align_to(new_size, sizeof(void*));
+
+        if (aligned_new_size <= reserved - start && commit(start + aligned_new_size)) {
+            off = start + aligned_new_size;
+            OK_ALLOCATOR_STAT(on_resize(old_size, new_size));
+            return old_ptr;
+        }
+
+        return nullptr;
+    }
+
+    void* new_ptr = raw_alloc(new_size);
+    if (new_ptr == nullptr) return nullptr;
+
+    memcpy(new_ptr, old_ptr, min(old_size, new_size));
+    OK_ALLOCATOR_STAT(on_dealloc(old_size));
+    return new_ptr;
+}
+
+void VirtualArenaAllocator::decommit() {
+    size_t keep = align_to(off, granularity);
+    if (keep >= committed) return;
+
+    uint8_t* start = base + keep;
+    size_t shrink = committed - keep;
+
+#if OK_UNIX
+    // dropping the pages before removing access makes the kernel reclaim them right away
+    ::madvise(start, shrink, MADV_DONTNEED);
+    ::mprotect(start, shrink, PROT_NONE);
+#elif OK_WINDOWS
+    ::VirtualFree(start, shrink, MEM_DECOMMIT);
+#endif // OK_UNIX
+
+    OK_ALLOCATOR_STAT(on_decommit(shrink));
+    committed = keep;
+}
+
+void VirtualArenaAllocator::free() {
+    if (mapping != nullptr) {
+#if OK_UNIX
+        ::munmap(mapping, mapping_size);
+#elif OK_WINDOWS
+        ::VirtualFree(mapping, 0, MEM_RELEASE);
+#endif // OK_UNIX
+    }
+
+    base = nullptr;
+    mapping = nullptr;
+    mapping_size = 0;
+    reserved = 0;
+    committed = 0;
+    off = 0;
+    OK_ALLOCATOR_STAT(on_release());
+}
+
+void TracingAllocator::init(TracingAllocator* out, Allocator* parent, size_t event_capacity) {
+    out->parent = parent;
+    out->event_count = 0;
+    out->site_file = nullptr;
+    out->site_line = 0;
+
+#if OK_ALLOCATOR_TRACING
+    out->event_capacity = round_up_pow2(event_capacity);
+    out->events = parent->alloc<Event>(out->event_capacity);
+#else
+    OK_UNUSED(event_capacity);
+    out->event_capacity = 0;
+    out->events = nullptr;
+#endif // OK_ALLOCATOR_TRACING
+}
+
+void TracingAllocator::record(EventKind kind, void* caller, void* ptr, size_t size, size_t old_size) {
+    Event* event = &events[event_count & (event_capacity - 1)];
+
+    event->file = site_file;
+    event->caller = caller;
+    event->ptr = ptr;
+    event->size = size;
+    event->old_size = old_size;
+    event->line = site_line;
+    event->kind = kind;
+
+    event_count++;
+    site_file = nullptr;
+    site_line = 0;
+}
+
+void* TracingAllocator::raw_alloc(size_t size) {
+    void* ptr = parent->raw_alloc(size);
+    OK_ALLOCATOR_STAT(on_alloc(size, size));
+#if OK_ALLOCATOR_TRACING
+    record(EventKind::ALLOC, OK_RETURN_ADDRESS(), ptr, size, 0);
+#endif // OK_ALLOCATOR_TRACING
+    return ptr;
+}
+
+void TracingAllocator::raw_dealloc(void* ptr, size_t size) {
+    parent->raw_dealloc(ptr, size);
+    OK_ALLOCATOR_STAT(on_dealloc(size));
+#if OK_ALLOCATOR_TRACING
+    record(EventKind::DEALLOC, OK_RETURN_ADDRESS(), ptr, size, 0);
+#endif // OK_ALLOCATOR_TRACING
+}
+
+void* TracingAllocator::raw_resize(void* ptr, size_t old_size, size_t new_size) {
+    void* new_ptr = parent->raw_resize(ptr, old_size, new_size);
+    OK_ALLOCATOR_STAT(on_resize(old_size, new_size));
+#if OK_ALLOCATOR_TRACING
+    record(EventKind::RESIZE, OK_RETURN_ADDRESS(), new_ptr, new_size, old_size);
+#endif // OK_ALLOCATOR_TRACING
+    return new_ptr;
+}
+
+void TracingAllocator::report() const {
+    static const char* KIND_NAMES[] = {"alloc", "dealloc", "resize"};
+
+    fprintf(stderr, "TracingAllocator: %zu events, last %zu:\n", event_count, retained());
+
+    for (size_t i = 0; i < retained(); i++) {
+        const Event& e = event(i);
+
+        fprintf(stderr, "  %-7s %p %zu", KIND_NAMES[(size_t)e.kind], e.ptr, e.size);
+        if (e.kind == EventKind::RESIZE) fprintf(stderr, " (was %zu)", e.old_size);
+
+        if (e.file != nullptr) fprintf(stderr, " at %s:%u\n", e.file, e.line);
+        else fprintf(stderr, " from %p\n", e.caller);
+    }
+
+#if OK_ALLOCATOR_STATS
+    fprintf(stderr, "  live %zu bytes in %zu allocations, peak %zu bytes, %zu allocations in total\n",
+            stats.live_bytes(), stats.live_count, stats.peak_bytes, stats.allocation_count);
+#endif // OK_ALLOCATOR_STATS
+}
+
+void TracingAllocator::free() {
+    if (events != nullptr) parent->dealloc(events, event_capacity);
+    events = nullptr;
+    event_capacity = 0;
+    event_count = 0;
+}
+
+// STRING IMPLEMENTATION
+
+String String::alloc(Allocator* a, size_t capacity) {
+    String s{};
+    s.allocator = a;
+    if (capacity > INLINE_CAPACITY) s.reserve(capacity);
+
+    return s;
+}
+
+String String::alloc(Allocator* a, const char* data, size_t data_len) {
+    auto s = String::alloc(a, data_len);
+
+    memcpy(s.data(), data, data_len);
+    s.set_count(data_len);
+
+    return s;
+}
+
+String String::alloc(Allocator* a, const char* data) {
+    size_t data_len = strlen((const char*)data);
+    return String::alloc(a, data, data_len);
+}
+
+// Takes ownership of the list. Short lists are copied in place and given back to their allocator
+String String::from(List<char> chars) {
+    if (chars.count <= INLINE_CAPACITY) {
+        String s = String::alloc(chars.allocator, chars.items, chars.count);
+        chars.allocator->dealloc(chars.items, chars.capacity);
+        return s;
+    }
+
+    chars.push(NULL_CHAR);
+
+    String s{};
+    s.allocator = chars.allocator;
+    s.heap.items = chars.items;
+    s.heap.count = chars.count - 1;
+    s.heap.capacity_lo = (uint32_t)chars.capacity;
+    s.heap.capacity_hi = (uint16_t)((uint64_t)chars.capacity >> 32);
+    s.heap.tag = HEAP_TAG;
+
+    return s;
+}
+
+String String::from(List<uint8_t> bytes) {
+    List<char> chars = bytes.cast<char>();
+    return String::from(chars);
+}
+
+// Formats into the spare capacity first, so the format string is only run twice when the result does not fit
+static void _string_vappend(String* s, const char* fmt, va_list args) {
+    size_t old_count = s->count();
+    size_t available = s->capacity() - old_count;
+
+    va_list retry_args;
+    va_copy(retry_args, args);
+
+    int required = vsnprintf(s->data() + old_count, available + 1, fmt, args);
+    OK_ASSERT(required != -1);
+
+    if ((size_t)required > available) {
+        s->reserve(old_count + required);
+
+        int bytes_written = vsnprintf(s->data() + old_count, required + 1, fmt, retry_args);
+        OK_ASSERT(bytes_written == required);
+    }
+
+    va_end(retry_args);
+    s->set_count(old_count + required);
+}
+
+String String::format(Allocator* a, const char* fmt, ...) {
+    auto buf = String::alloc(a);
+
+    va_list sprintf_args;
+    va_start(sprintf_args, fmt);
+    _string_vappend(&buf, fmt, sprintf_args);
+    va_end(sprintf_args);
+
+    return buf;
+}
+
+void String::reserve(size_t chars) {
+    size_t old_capacity = capacity();
+    if (chars <= old_capacity) return;
+
+    OK_ASSERT(allocator != nullptr);
+    OK_ASSERT((uint64_t)chars < ((uint64_t)1 << 48));
+
+    size_t n = count();
+    size_t new_size = chars + 1;
+    char* items;
+
+    if (is_inline()) {
+        items = allocator->alloc<char>(new_size);
+        memcpy(items, small, n + 1);
+    } else {
+        items = allocator->resize(heap.items, old_capacity + 1, new_size);
+    }
+
+    heap.items = items;
+    heap.count = n;
+    heap.capacity_lo = (uint32_t)new_size;
+    heap.capacity_hi = (uint16_t)((uint64_t)new_size >> 32);
+    heap.tag = HEAP_TAG;
+}
+
+void String::free() {
+    if (!is_inline()) allocator->dealloc(heap.items, capacity() + 1);
+
+    Allocator* a = allocator;
+    *this = String{};
+    allocator = a;
+}
+
+void String::append(StringView sv) {
+    size_t n = count();
+    if (n + sv.count > capacity()) reserve(max(n + sv.count, capacity() * 2));
+
+    memcpy(data() + n, sv.data, sv.count);
+    set_count(n + sv.count);
+}
+
+void String::append(const String& str) {
+    append(str.view());
+}
+
+void String::format_append(const char* fmt, ...) {
+    va_list sprintf_args;
+    va_start(sprintf_args, fmt);
+    _string_vappend(this, fmt, sprintf_args);
+    va_end(sprintf_args);
+}
+
+void String::append_int(int64_t value) {
+    size_t n = count();
+    reserve(n + MAX_INT_CHARS);
+    set_count(n + to_chars(data() + n, value));
+}
+
+void String::append_uint(uint64_t value) {
+    size_t n = count();
+    reserve(n + MAX_INT_CHARS);
+    set_count(n + to_chars(data() + n, value));
+}
+
+void String::append_double(double value) {
+    size_t n = count();
+    reserve(n + MAX_DOUBLE_CHARS);
+    set_count(n + to_chars(data() + n, value));
+}
+
+bool String::starts_with(StringView prefix) {
+    return view().starts_with(prefix);
+}
+
+// STRING VIEW IMPLEMENTATION
+bool StringView::operator ==(const String& string) const {
+    return *this == string.view();
+}
+
+String StringView::to_string(Allocator* a) const {
+    return String::alloc(a, data, count);
+}
+
+// Views that run out of bytes sort before every byte value
+static inline size_t _radix_byte(StringView sv, size_t depth) {
+    return depth < sv.count ? (size_t)(uint8_t)sv.data[depth] + 1 : 0;
+}
+
+// Buckets that are small or share a long prefix are left to the comparison sorts,
+// which also bounds the recursion depth
+static void _msd_radix_sort(StringView* items, StringView* buffer, size_t count, size_t depth) {
+    static constexpr size_t MAX_RADIX_DEPTH = 32;
+
+    Less less{};
+
+    if (count <= _INSERTION_SORT_THRESHOLD) {
+        _insertion_sort(items, items + count, less);
+        return;
+    }
+
+    if (depth >= MAX_RADIX_DEPTH) {
+        sort(items, count, less);
+        return;
+    }
+
+    size_t ends[257] = {};
+    for (size_t i = 0; i < count; i++) ends[_radix_byte(items[i], depth)]++;
+
+    // all of them ended, so they are equal
+    if (ends[0] == count) return;
+
+    size_t offset = 0;
+    for (size_t bucket = 0; bucket < 257; bucket++) {
+        size_t n = ends[bucket];
+        ends[bucket] = offset;
+        offset += n;
+    }
+
+    for (size_t i = 0; i < count; i++) buffer[ends[_radix_byte(items[i], depth)]++] = items[i];
+    memcpy((void*)items, (const void*)buffer, count * sizeof(StringView));
+
+    for (size_t bucket = 1; bucket < 257; bucket++) {
+        size_t start = ends[bucket - 1];
+        size_t n = ends[bucket] - start;
+        if (n > 1) _msd_radix_sort(items + start, buffer, n, depth + 1);
+    }
+}
+
+void radix_sort(StringView* items, size_t count, Allocator* scratch) {
+    if (count < 2) return;
+
+    StringView* buffer = scratch->alloc<StringView>(count);
+    _msd_radix_sort(items, buffer, count, 0);
+    scratch->dealloc(buffer, count);
+}
+
+size_t StringView::find(char c, size_t start) const {
+    size_t i = start;
+
+    for (; i + ByteBlock::WIDTH <= count; i += ByteBlock::WIDTH) {
+        auto mask = ByteBlock{data + i}.match(c);
+        if (mask.any()) return i + mask.lowest();
+    }
+
+    for (; i < count; i++) {
+        if (data[i] == c) return i;
+    }
+
+    return NPOS;
+}
+
+// Blocks are filtered on the first and last char of the needle, only the candidates
+// that match both are compared in full
+size_t StringView::find(StringView needle, size_t start) const {
+    if (needle.count == 0) return start <= count ? start : NPOS;
+    if (needle.count == 1) return find(needle.data[0], start);
+    if (start > count || needle.count > count - start) return NPOS;
+
+    size_t last = needle.count - 1;
+    char first_char = needle.data[0];
+    char last_char = needle.data[last];
+
+    size_t i = start;
+
+    for (; i + last + ByteBlock::WIDTH <= count; i += ByteBlock::WIDTH) {
+        auto firsts = ByteBlock{data + i}.match(first_char);
+        auto lasts = ByteBlock{data + i + last}.match(last_char);
+        ByteBlock::Mask candidates{firsts.bits & lasts.bits};
+
+        for (; candidates.any(); candidates.clear_lowest()) {
+            size_t idx = i + candidates.lowest();
+            if (memcmp(data + idx + 1, needle.data + 1, last - 1) == 0) return idx;
+        }
+    }
+
+    for (; i + needle.count <= count; i++) {
+        if (data[i] == first_char && memcmp(data + i + 1, needle.data + 1, last) == 0) return i;
+    }
+
+    return NPOS;
+}
+
+// Small sets are matched a block at a time, bigger ones go through a lookup table
+size_t StringView::find_any_of(StringView chars, size_t start) const {
+    static constexpr size_t MAX_BLOCK_SET = 8;
+
+    if (chars.count == 0) return NPOS;
+    if (chars.count == 1) return find(chars.data[0], start);
+
+    size_t i = start;
+
+    if (chars.count <= MAX_BLOCK_SET) {
+        for (; i + ByteBlock::WIDTH <= count; i += ByteBlock::WIDTH) {
+            ByteBlock block{data + i};
+            ByteBlock::Mask mask{0};
+
+            for (size_t j = 0; j < chars.count; j++) mask.bits |= block.match(chars.data[j]).bits;
+            if (mask.any()) return i + mask.lowest();
+        }
+    }
+
+    bool table[256] = {};
+    for (size_t j = 0; j < chars.count; j++) table[(uint8_t)chars.data[j]] = true;
+
+    for (; i < count; i++) {
+        if (table[(uint8_t)data[i]]) return i;
+    }
+
+    return NPOS;
+}
+
+size_t StringView::count_of(char c) const {
+    size_t result = 0;
+    size_t i = 0;
+
+    for (; i + ByteBlock::WIDTH <= count; i += ByteBlock::WIDTH) {
+        result += count_ones(ByteBlock{data + i}.match(c).bits);
+    }
+
+    for (; i < count; i++) result += data[i] == c;
+
+    return result;
+}
+
+// STRING INTERNER IMPLEMENTATION
+StringInterner StringInterner::alloc(Allocator* a, size_t capacity) {
+    StringInterner interner{};
+
+    interner.strings = List<StringView>::alloc(a, capacity);
+    interner.ids = Table<StringView, uint32_t>::alloc(a, table_capacity_for(capacity));
+
+    return interner;
+}
+
+Symbol StringInterner::intern(StringView string) {
+    uint64_t hash = Hash<StringView>::hash(string);
+    size_t idx = ids.find_index(string, hash);
+
+    if (idx != (size_t)-1) return Symbol{ids.value_at(idx)};
+
+    OK_ASSERT(strings.count < UINT32_MAX);
+
+    StringView stored{"", 0};
+
+    if (string.count > 0) {
+        char* data = bytes.alloc<char>(string.count);
+        memcpy(data, string.data, string.count);
+        stored = StringView{data, string.count};
+    }
+
+    auto id = (uint32_t)strings.count;
+    strings.push(stored);
+
+    // the hash is of the same bytes, so it is reused for the insertion
+    idx = ids.insert_index(hash);
+    ids.key_at(idx) = stored;
+    ids.value_at(idx) = id;
+
+    return Symbol{id};
+}
+
+Optional<Symbol> StringInterner::find(StringView string) const {
+    size_t idx = ids.find_index(string, Hash<StringView>::hash(string));
+    if (idx == (size_t)-1) return {};
+    return Symbol{ids.value_at(idx)};
+}
+
+void StringInterner::free() {
+    ids.free();
+    strings.free();
+    bytes.free();
+}
+
+// FILESYSTEM API IMPLEMENTATION
+static File::OpenError _to_open_error(int error, const char* path) {
+    using OpenError = File::OpenError;
+
+    switch (error) {
+    case EACCES:       return OpenError::ACCESS_DENIED;
+    case EINVAL:       return OpenError::INVALID_PATH;
+    case EISDIR:       return OpenError::IS_DIRECTORY;
+    case ELOOP:        return OpenError::TOO_MANY_SYMLINKS;
+    case EMFILE:       return OpenError::PROCESS_OPEN_FILES_LIMIT_REACHED;
+    case ENFILE:       return OpenError::SYSTEM_OPEN_FILES_LIMIT_REACHED;
+    case ENAMETOOLONG: return OpenError::PATH_TOO_LONG;
+    case ENOMEM:       return OpenError::KERNEL_OUT_OF_MEMORY;
+    case ENOSPC:       return OpenError::OUT_OF_SPACE;
+    case ENXIO:        return OpenError::IS_SOCKET;
+    case EOVERFLOW:    return OpenError::FILE_TOO_BIG;
+    case EROFS:        return OpenError::READONLY_FILE;
+    case EFAULT:       OK_PANIC_FMT("Parameter 'path' (%p) is not mapped to the current process", path);
+    default:           OK_UNREACHABLE();
+    }
+}
+
+Optional<File::OpenError> File::open(File* out, const char* path) {
+#if OK_UNIX
+    int fd = ::open(path, O_RDWR);
+    int error = errno;
+#elif OK_WINDOWS
+    int fd;
+    errno_t error = ::_sopen_s(&fd, path, _O_RDWR, _SH_DENYNO, 0);
+#endif // OK_UNIX
+
+    if (fd < 0) return _to_open_error(error, path);
+
+    out->fd = fd;
+    out->path = path;
+
+    return {};
+}
+
+Optional<File::OpenError> File::create(File* out, const char* path) {
+#if OK_UNIX
+    int fd = ::open(path, O_RDWR | O_CREAT | O_TRUNC, 0644);
+    int error = errno;
+#elif OK_WINDOWS
+    int fd;
+    errno_t error = ::_sopen_s(&fd, path, _O_RDWR | _O_CREAT | _O_TRUNC | _O_BINARY, _SH_DENYNO, _S_IREAD | _S_IWRITE);
+#endif // OK_UNIX
+
+    if (fd < 0) return _to_open_error(error, path);
+
+    out->fd = fd;
+    out->path = path;
+
+    return {};
+}
+
+void File::close() {
+#if OK_UNIX
+    ::close(fd);
+#elif OK_WINDOWS
+    ::_close(fd);
+#endif // OK_UNIX
+
+    fd = -1;
+}
+
+static inline off_t _lseek(int fd, off_t offset, int whence) {
+#if OK_UNIX
+    return ::lseek(fd, offset, whence);
+#elif OK_WINDOWS
+    return ::_lseek(fd, offset, whence);
+#endif // OK_UNIX
+}
+
+void File::seek_start() const {
+    off_t seek_res = _lseek(fd, 0, SEEK_SET);
+    OK_ASSERT(seek_res != (off_t)-1);
+}
+
+off_t File::seek_end() const {
+    off_t seek_res = _lseek(fd, 0, SEEK_END);
+    OK_ASSERT(seek_res != (off_t)-1);
+
+    return seek_res;
+}
+
+size_t File::size() const {
+#if OK_UNIX
+    struct stat st;
+    int res = ::fstat(fd, &st);
+#elif OK_WINDOWS
+    struct _stat64 st;
+    int res = ::_fstat64(fd, &st);
+#endif // OK_UNIX
+
+    OK_ASSERT(res == 0);
+    return (size_t)st.st_size;
+}
+
+static inline int64_t _read(int fd, void* buffer, size_t count) {
+#if OK_UNIX
+    return ::read(fd, buffer, count);
+#elif OK_WINDOWS
+    return ::_read(fd, buffer, (unsigned int)count);
+#endif // OK_UNIX
+}
+
+static inline int64_t _write(int fd, const void* buffer, size_t count) {
+#if OK_UNIX
+    return ::write(fd, buffer, count);
+#elif OK_WINDOWS
+    return ::_write(fd, buffer, (unsigned int)count);
+#endif // OK_UNIX
+}
+
+static File::ReadError _to_read_error(int error, const void* buf) {
+    switch (error) {
+    case EIO: return File::ReadError::IO_ERROR;
+    case EFAULT: OK_PANIC_FMT("The buffer (%p) is mapped outside the current process", buf);
+    default: OK_UNREACHABLE();
+    }
+}
+
+static File::WriteError _to_write_error(int error, const void* buf) {
+    using WriteError = File::WriteError;
+
+    switch (error) {
+    case EIO:    return WriteError::IO_ERROR;
+    case ENOSPC: return WriteError::OUT_OF_SPACE;
+#ifdef EDQUOT
+    case EDQUOT: return WriteError::QUOTA_EXCEEDED;
+#endif // EDQUOT
+    case EFBIG:  return WriteError::FILE_TOO_BIG;
+    case EPIPE:  return WriteError::BROKEN_PIPE;
+    case EFAULT: OK_PANIC_FMT("The buffer (%p) is mapped outside the current process", buf);
+    default:     OK_UNREACHABLE();
+    }
+}
+
+Optional<File::ReadError> File::read_some(uint8_t* buf, size_t count, size_t* bytes_read) {
+    int64_t r;
+
+    do {
+        r = ok::_read(fd, buf, count);
+    } while (r < 0 && errno == EINTR);
+
+    if (r < 0) return _to_read_error(errno, buf);
+
+    *bytes_read = (size_t)r;
+    return {};
+}
+
+Optional<File::ReadError> File::read(uint8_t* buf, size_t count, size_t* bytes_read) {
+    size_t total = 0;
+
+    while (total < count) {
+        size_t n;
+        auto err = read_some(buf + total, count - total, &n);
+
+        if (err.has_value()) return err;
+        if (n == 0) break;
+
+        total += n;
+    }
+
+    if (bytes_read != nullptr) *bytes_read = total;
+    return {};
+}
+
+Optional<File::WriteError> File::write(const uint8_t* buf, size_t count) {
+    size_t total = 0;
+
+    while (total < count) {
+        int64_t r = ok::_write(fd, buf + total, count - total);
+
+        if (r < 0) {
+            if (errno == EINTR) continue;
+            return _to_write_error(errno, buf);
+        }
+
+        total += (size_t)r;
+    }
+
+    return {};
+}
+
+static inline int64_t _pread(int fd, void* buffer, size_t count, uint64_t offset) {
+#if OK_UNIX
+    return ::pread(fd, buffer, count, (off_t)offset);
+#elif OK_WINDOWS
+    OVERLAPPED overlapped{};
+    overlapped.Offset = (DWORD)offset;
+    overlapped.OffsetHigh = (DWORD)(offset >> 32);
+
+    DWORD n;
+    DWORD to_read = count > 0xFFFFFFFF ? 0xFFFFFFFF : (DWORD)count;
+    if (::ReadFile((HANDLE)::_get_osfhandle(fd), buffer, to_read, &n, &overlapped)) return n;
+    if (::GetLastError() == ERROR_HANDLE_EOF) return 0;
+
+    errno = EIO;
+    return -1;
+#endif // OK_UNIX
+}
+
+static inline int64_t _pwrite(int fd, const void* buffer, size_t count, uint64_t offset) {
+#if OK_UNIX
+    return ::pwrite(fd, buffer, count, (off_t)offset);
+#elif OK_WINDOWS
+    OVERLAPPED overlapped{};
+    overlapped.Offset = (DWORD)offset;
+    overlapped.OffsetHigh = (DWORD)(offset >> 32);
+
+    DWORD n;
+    DWORD to_write = count > 0xFFFFFFFF ? 0xFFFFFFFF : (DWORD)count;
+    if (::WriteFile((HANDLE)::_get_osfhandle(fd), buffer, to_write, &n, &overlapped)) return n;
+
+    errno = ::GetLastError() == ERROR_DISK_FULL ? ENOSPC : EIO;
+    return -1;
+#endif // OK_UNIX
+}
+
+Optional<File::ReadError> File::read_at(uint8_t* buf, size_t count, uint64_t offset, size_t* bytes_read) {
+    size_t total = 0;
+
+    while (total < count) {
+        int64_t r = ok::_pread(fd, buf + total, count - total, offset + total);
+
+        if (r < 0) {
+            if (errno == EINTR) continue;
+            return _to_read_error(errno, buf);
+        }
+
+        if (r == 0) break;
+        total += (size_t)r;
+    }
+
+    if (bytes_read != nullptr) *bytes_read = total;
+    return {};
+}
+
+Optional<File::WriteError> File::write_at(const uint8_t* buf, size_t count, uint64_t offset) {
+    size_t total = 0;
+
+    while (total < count) {
+        int64_t r = ok::_pwrite(fd, buf + total, count - total, offset + total);
+
+        if (r < 0) {
+            if (errno == EINTR) continue;
+            return _to_write_error(errno, buf);
+        }
+
+        total += (size_t)r;
+    }
+
+    return {};
+}
+
+// iovecs handed to the kernel per call
+#define OK_IOV_BATCH 64
+
+#define OK_NO_OFFSET ((uint64_t)-1)
+
+static Optional<File::ReadError> _readv(int fd, Slice<List<uint8_t>*> buffers, uint64_t offset, size_t* bytes_read) {
+    size_t total = 0;
+    size_t first = 0;
+
+    while (first < buffers.count) {
+        List<uint8_t>* list = buffers[first];
+
+        if (list->count == list->capacity) {
+            first++;
+            continue;
+        }
+
+#if OK_UNIX
+        struct iovec iov[OK_IOV_BATCH];
+        int iov_count = 0;
+
+        for (size_t i = first; i < buffers.count && iov_count < OK_IOV_BATCH; i++) {
+            List<uint8_t>* b = buffers[i];
+            if (b->count == b->capacity) continue;
+
+            iov[iov_count].iov_base = b->items + b->count;
+            iov[iov_count].iov_len = b->capacity - b->count;
+            iov_count++;
+        }
+
+        int64_t r = offset == OK_NO_OFFSET
+            ? ::readv(fd, iov, iov_count)
+            : ::preadv(fd, iov, iov_count, (off_t)(offset + total));
+#elif OK_WINDOWS
+        int64_t r = offset == OK_NO_OFFSET
+            ? ok::_read(fd, list->items + list->count, list->capacity - list->count)
+            : ok::_pread(fd, list->items + list->count, list->capacity - list->count, offset + total);
+#endif // OK_UNIX
+
+        if (r < 0) {
+            if (errno == EINTR) continue;
+            return _to_read_error(errno, list->items);
+        }
+
+        if (r == 0) break;
+
+        total += (size_t)r;
+
+        for (size_t i = first; r > 0; i++) {
+            List<uint8_t>* b = buffers[i];
+            size_t n = min((size_t)r, b->capacity - b->count);
+
+            b->count += n;
+            r -= n;
+        }
+    }
+
+    if (bytes_read != nullptr) *bytes_read = total;
+    return {};
+}
+
+static Optional<File::WriteError> _writev(int fd, Slice<Slice<uint8_t>> buffers, uint64_t offset) {
+    size_t total = 0;
+    size_t first = 0;
+    // bytes of the first buffer that were already written
+    size_t first_off = 0;
+
+    while (first < buffers.count) {
+        if (first_off == buffers[first].count) {
+            first++;
+            first_off = 0;
+            continue;
+        }
+
+#if OK_UNIX
+        struct iovec iov[OK_IOV_BATCH];
+        int iov_count = 0;
+
+        for (size_t i = first; i < buffers.count && iov_count < OK_IOV_BATCH; i++) {
+            size_t skip = i == first ? first_off : 0;
+
+            iov[iov_count].iov_base = (void*)(buffers[i].items + skip);
+            iov[iov_count].iov_len = buffers[i].count - skip;
+            iov_count++;
+        }
+
+        int64_t r = offset == OK_NO_OFFSET
+            ? ::writev(fd, iov, iov_count)
+            : ::pwritev(fd, iov, iov_count, (off_t)(offset + total));
+#elif OK_WINDOWS
+        const uint8_t* data = buffers[first].items + first_off;
+        size_t data_count = buffers[first].count - first_off;
+
+        int64_t r = offset == OK_NO_OFFSET
+            ? ok::_write(fd, data, data_count)
+            : ok::_pwrite(fd, data, data_count, offset + total);
+#endif // OK_UNIX
+
+        if (r < 0) {
+            if (errno == EINTR) continue;
+            return _to_write_error(errno, buffers[first].items);
+        }
+
+        total += (size_t)r;
+
+        while (r > 0) {
+            size_t n = min((size_t)r, buffers[first].count - first_off);
+            first_off += n;
+            r -= n;
+
+            if (first_off == buffers[first].count) {
+                first++;
+                first_off = 0;
+            }
+        }
+    }
+
+    return {};
+}
+
+Optional<File::ReadError> File::readv(Slice<List<uint8_t>*> buffers, size_t* bytes_read) {
+    return _readv(fd, buffers, OK_NO_OFFSET, bytes_read);
+}
+
+Optional<File::ReadError> File::readv_at(Slice<List<uint8_t>*> buffers, uint64_t offset, size_t* bytes_read) {
+    return _readv(fd, buffers, offset, bytes_read);
+}
+
+Optional<File::WriteError> File::writev(Slice<Slice<uint8_t>> buffers) {
+    return _writev(fd, buffers, OK_NO_OFFSET);
+}
+
+Optional<File::WriteError> File::writev_at(Slice<Slice<uint8_t>> buffers, uint64_t offset) {
+    return _writev(fd, buffers, offset);
+}
+
+Optional<File::ReadError> File::read_full(Allocator* a, List<uint8_t>* out) {
+    size_t sz = size();
+    *out = List<uint8_t>::alloc(a, sz);
+
+    // positional, so whatever was read from the file before does not matter
+    size_t n = 0;
+    auto err = read_at(out->items, sz, 0, &n);
+    out->count = n;
+    return err;
+}
+
+Optional<File::MapError> File::map(Mapping* out, AccessPattern pattern) const {
+    size_t sz = size();
+
+    if (sz == 0) {
+        out->data = nullptr;
+        out->size = 0;
+        return {};
+    }
+
+#if OK_UNIX
+    void* ptr = ::mmap(nullptr, sz, PROT_READ, MAP_PRIVATE, fd, 0);
+
+    if (ptr == MAP_FAILED) {
+        switch (errno) {
+        case EACCES:    return MapError::ACCESS_DENIED;
+        case ENODEV:    return MapError::NOT_MAPPABLE;
+        case EINVAL:    return MapError::NOT_MAPPABLE;
+        case ENOMEM:    return MapError::OUT_OF_MEMORY;
+        case EOVERFLOW: return MapError::FILE_TOO_BIG;
+        default:        OK_UNREACHABLE();
+        }
+    }
+
+    switch (pattern) {
+    case AccessPattern::NORMAL:     break;
+    case AccessPattern::SEQUENTIAL: ::madvise(ptr, sz, MADV_SEQUENTIAL); break;
+    case AccessPattern::RANDOM:     ::madvise(ptr, sz, MADV_RANDOM); break;
+    }
+#elif OK_WINDOWS
+    OK_UNUSED(pattern);
+
+    HANDLE file_handle = (HANDLE)::_get_osfhandle(fd);
+    HANDLE mapping = ::CreateFileMappingA(file_handle, nullptr, PAGE_READONLY, 0, 0, nullptr);
+
+    if (mapping == nullptr) {
+        switch (::GetLastError()) {
+        case ERROR_ACCESS_DENIED:       return MapError::ACCESS_DENIED;
+        case ERROR_NOT_ENOUGH_MEMORY:   return MapError::OUT_OF_MEMORY;
+        case ERROR_FILE_TOO_LARGE:      return MapError::FILE_TOO_BIG;
+        default:                        return MapError::NOT_MAPPABLE;
+        }
+    }
+
+    void* ptr = ::MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+    // the view keeps the mapping object alive on its own
+    ::CloseHandle(mapping);
+
+    if (ptr == nullptr) return MapError::OUT_OF_MEMORY;
+#endif // OK_UNIX
+
+    out->data = (const uint8_t*)ptr;
+    out->size = sz;
+
+    return {};
+}
+
+void File::Mapping::unmap() {
+    if (data == nullptr) return;
+
+#if OK_UNIX
+    ::munmap((void*)data, size);
+#elif OK_WINDOWS
+    ::UnmapViewOfFile(data);
+#endif // OK_UNIX
+
+    data = nullptr;
+    size = 0;
+}
+
+// BUFFERED IO IMPLEMENTATION
+BufferedReader BufferedReader::alloc(Allocator* a, File* file, size_t buffer_size) {
+    BufferedReader reader{};
+    reader.file = file;
+    reader.allocator = a;
+    reader.buffer = a->alloc<uint8_t>(buffer_size);
+    reader.capacity = buffer_size;
+    return reader;
+}
+
+Optional<File::ReadError> BufferedReader::fill() {
+    if (start > 0) {
+        memmove(buffer, buffer + start, end - start);
+        end -= start;
+        start = 0;
+    }
+
+    if (end == capacity) {
+        size_t new_capacity = capacity * 2;
+        buffer = allocator->resize<uint8_t>(buffer, capacity, new_capacity);
+        capacity = new_capacity;
+    }
+
+    size_t n;
+    auto err = file->read_some(buffer + end, capacity - end, &n);
+    if (err.has_value()) return err;
+
+    if (n == 0) eof = true;
+    end += n;
+
+    return {};
+}
+
+Optional<File::ReadError> BufferedReader::read(uint8_t* buf, size_t count, size_t* bytes_read) {
+    size_t total = 0;
+
+    while (total < count) {
+        if (start == end) {
+            if (eof) break;
+
+            // big reads skip the buffer entirely
+            if (count - total >= capacity) {
+                size_t n;
+                auto err = file->read(buf + total, count - total, &n);
+                if (err.has_value()) return err;
+
+                total += n;
+                eof = total < count;
+                break;
+            }
+
+            auto err = fill();
+            if (err.has_value()) return err;
+            continue;
+        }
+
+        size_t n = min(count - total, end - start);
+        memcpy(buf + total, buffer + start, n);
+        start += n;
+        total += n;
+    }
+
+    *bytes_read = total;
+    return {};
+}
+
+Optional<File::ReadError> BufferedReader::read_until(char delim, Optional<StringView>* out) {
+    size_t scanned = 0;
+
+    while (true) {
+        auto* hit = (uint8_t*)memchr(buffer + start + scanned, delim, end - start - scanned);
+
+        if (hit != nullptr) {
+            *out = StringView{(const char*)buffer + start, (size_t)(hit - (buffer + start))};
+            start = hit - buffer + 1;
+            return {};
+        }
+
+        scanned = end - start;
+
+        if (eof) {
+            if (start == end) {
+                *out = {};
+            } else {
+                *out = buffered();
+                start = end;
+            }
+
+            return {};
+        }
+
+        auto err = fill();
+        if (err.has_value()) return err;
+    }
+}
+
+Optional<File::ReadError> BufferedReader::read_line(Optional<StringView>* out) {
+    auto err = read_until('\n', out);
+    if (err.has_value() || !out->has_value()) return err;
+
+    StringView& line = out->get();
+    if (line.count > 0 && line.data[line.count - 1] == '\r') line.count--;
+
+    return {};
+}
+
+BufferedWriter BufferedWriter::alloc(Allocator* a, File* file, size_t buffer_size) {
+    BufferedWriter writer{};
+    writer.file = file;
+    writer.allocator = a;
+    writer.buffer = a->alloc<uint8_t>(buffer_size);
+    writer.capacity = buffer_size;
+    return writer;
+}
+
+Optional<File::WriteError> BufferedWriter::write(const uint8_t* data, size_t data_count) {
+    if (capacity - count >= data_count) {
+        memcpy(buffer + count, data, data_count);
+        count += data_count;
+        return {};
+    }
+
+    // returning the Optional itself trips GCC's maybe-uninitialized check once this is inlined
+    auto err = flush();
+    if (err.has_value()) return err.get();
+
+    if (data_count >= capacity) return file->write(data, data_count);
+
+    memcpy(buffer, data, data_count);
+    count = data_count;
+
+    return {};
+}
+
+Optional<File::WriteError> BufferedWriter::flush() {
+    if (count == 0) return {};
+
+    auto err = file->write(buffer, count);
+    count = 0;
+    if (err.has_value()) return err.get();
+    return {};
+}
+
+// DIRECTORY IMPLEMENTATION
+static inline bool _is_dot_entry(const char* name) {
+    return name[0] == '.' && (name[1] == '\0' || (name[1] == '.' && name[2] == '\0'));
+}
+
+#if OK_UNIX
+static DirectoryIterator::OpenError _to_directory_open_error(int error, const char* path) {
+    using OpenError = DirectoryIterator::OpenError;
+
+    switch (error) {
+    case EACCES:
+    case EPERM:        return OpenError::ACCESS_DENIED;
+    case ENOENT:       return OpenError::NOT_FOUND;
+    case ENOTDIR:      return OpenError::NOT_A_DIRECTORY;
+    case ELOOP:        return OpenError::TOO_MANY_SYMLINKS;
+    case EMFILE:       return OpenError::PROCESS_OPEN_FILES_LIMIT_REACHED;
+    case ENFILE:       return OpenError::SYSTEM_OPEN_FILES_LIMIT_REACHED;
+    case ENAMETOOLONG: return OpenError::PATH_TOO_LONG;
+    case ENOMEM:       return OpenError::KERNEL_OUT_OF_MEMORY;
+    case EFAULT:       OK_PANIC_FMT("Parameter 'path' (%p) is not mapped to the current process", path);
+    // a walk opens whatever it finds, so odd filesystems must not bring it down
+    default:           return OpenError::IO_ERROR;
+    }
+}
+
+static DirectoryIterator::EntryType _entry_type_from_dirent(unsigned char type) {
+    using EntryType = DirectoryIterator::EntryType;
+
+    switch (type) {
+    case DT_REG:     return EntryType::FILE;
+    case DT_DIR:     return EntryType::DIRECTORY;
+    case DT_LNK:     return EntryType::SYMLINK;
+    case DT_UNKNOWN: return EntryType::UNKNOWN;
+    default:         return EntryType::OTHER;
+    }
+}
+
+static DirectoryIterator::EntryType _entry_type_from_mode(mode_t mode) {
+    using EntryType = DirectoryIterator::EntryType;
+
+    if (S_ISREG(mode)) return EntryType::FILE;
+    if (S_ISDIR(mode)) return EntryType::DIRECTORY;
+    if (S_ISLNK(mode)) return EntryType::SYMLINK;
+    return EntryType::OTHER;
+}
+#elif OK_WINDOWS
+static DirectoryIterator::EntryType _entry_type_from_attributes(DWORD attributes) {
+    using EntryType = DirectoryIterator::EntryType;
+
+    if (attributes & FILE_ATTRIBUTE_REPARSE_POINT) return EntryType::SYMLINK;
+    if (attributes & FILE_ATTRIBUTE_DIRECTORY) return EntryType::DIRECTORY;
+    return EntryType::FILE;
+}
+#endif // OK_UNIX
+
+#if OK_LINUX
+// glibc only declares it behind _GNU_SOURCE and other libcs not at all
+struct _LinuxDirent64 {
+    uint64_t d_ino;
+    int64_t d_off;
+    unsigned short d_reclen;
+    unsigned char d_type;
+    char d_name[1];
+};
+#endif // OK_LINUX
+
+Optional<DirectoryIterator::OpenError> DirectoryIterator::open(DirectoryIterator* out, Allocator* a, const char* path,
+                                                               size_t buffer_size) {
+    out->allocator = a;
+    out->buffer = nullptr;
+    out->capacity = 0;
+
+#if OK_LINUX
+    // getdents64 refuses buffers that cannot hold the longest possible entry
+    OK_ASSERT(buffer_size >= sizeof(_LinuxDirent64) + 256);
+
+    int fd = ::open(path, O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+    if (fd < 0) return _to_directory_open_error(errno, path);
+
+    out->fd = fd;
+    out->start = 0;
+    out->end = 0;
+    out->buffer = a->alloc<uint8_t>(buffer_size);
+    out->capacity = buffer_size;
+#elif OK_UNIX
+    // readdir keeps its own buffer
+    OK_UNUSED(buffer_size);
+
+    int fd = ::open(path, O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+    if (fd < 0) return _to_directory_open_error(errno, path);
+
+    out->dir = ::fdopendir(fd);
+    if (out->dir == nullptr) {
+        int error = errno;
+        ::close(fd);
+        return _to_directory_open_error(error, path);
+    }
+#elif OK_WINDOWS
+    // the large fetch sizes the buffer on its own
+    OK_UNUSED(buffer_size);
+
+    size_t length = strlen(path);
+    char* pattern = a->alloc<char>(length + 3);
+    memcpy(pattern, path, length);
+
+    size_t pattern_length = length;
+    if (length > 0 && path[length - 1] != '/' && path[length - 1] != '\\') pattern[pattern_length++] = '\\';
+    pattern[pattern_length++] = '*';
+    pattern[pattern_length] = '\0';
+
+    out->find = ::FindFirstFileExA(pattern, FindExInfoBasic, &out->data, FindExSearchNameMatch, nullptr,
+                                   FIND_FIRST_EX_LARGE_FETCH);
+    DWORD error = ::GetLastError();
+    a->dealloc(pattern, length + 3);
+
+    if (out->find == INVALID_HANDLE_VALUE) {
+        switch (error) {
+        case ERROR_ACCESS_DENIED:       return OpenError::ACCESS_DENIED;
+        case ERROR_DIRECTORY:           return OpenError::NOT_A_DIRECTORY;
+        case ERROR_FILENAME_EXCED_RANGE: return OpenError::PATH_TOO_LONG;
+        case ERROR_TOO_MANY_OPEN_FILES: return OpenError::PROCESS_OPEN_FILES_LIMIT_REACHED;
+        case ERROR_NOT_ENOUGH_MEMORY:   return OpenError::KERNEL_OUT_OF_MEMORY;
+        case ERROR_FILE_NOT_FOUND:
+        case ERROR_PATH_NOT_FOUND:      return OpenError::NOT_FOUND;
+        default:                        return OpenError::IO_ERROR;
+        }
+    }
+
+    out->pending = true;
+#endif // OK_LINUX
+
+    return {};
+}
+
+Optional<DirectoryIterator::ReadError> DirectoryIterator::next(Optional<Entry>* out) {
+    for (;;) {
+#if OK_LINUX
+        if (start >= end) {
+            long n = ::syscall(SYS_getdents64, fd, buffer, capacity);
+
+            if (n < 0) return errno == ENOENT ? ReadError::DIRECTORY_REMOVED : ReadError::IO_ERROR;
+            if (n == 0) {
+                *out = {};
+                return {};
+            }
+
+            start = 0;
+            end = (size_t)n;
+        }
+
+        auto* dirent = (_LinuxDirent64*)(buffer + start);
+        start += dirent->d_reclen;
+
+        const char* name = dirent->d_name;
+        EntryType type = _entry_type_from_dirent(dirent->d_type);
+#elif OK_UNIX
+        errno = 0;
+        struct dirent* dirent = ::readdir(dir);
+
+        if (dirent == nullptr) {
+            if (errno != 0) return ReadError::IO_ERROR;
+
+            *out = {};
+            return {};
+        }
+
+        const char* name = dirent->d_name;
+        EntryType type = _entry_type_from_dirent(dirent->d_type);
+#elif OK_WINDOWS
+        if (pending) {
+            pending = false;
+        } else if (!::FindNextFileA(find, &data)) {
+            if (::GetLastError() != ERROR_NO_MORE_FILES) return ReadError::IO_ERROR;
+
+            *out = {};
+            return {};
+        }
+
+        const char* name = data.cFileName;
+        EntryType type = _entry_type_from_attributes(data.dwFileAttributes);
+#endif // OK_LINUX
+
+        if (_is_dot_entry(name)) continue;
+
+        *out = Entry{StringView{name, strlen(name)}, type};
+        return {};
+    }
+}
+
+Optional<DirectoryIterator::StatError> DirectoryIterator::stat(const Entry& entry, Info* out) const {
+#if OK_UNIX
+#if OK_LINUX
+    int dir_fd = fd;
+#else
+    int dir_fd = ::dirfd(dir);
+#endif // OK_LINUX
+
+    // the names come straight from the kernel's buffer, so they are null-terminated
+    struct stat st;
+    if (::fstatat(dir_fd, entry.name.data, &st, AT_SYMLINK_NOFOLLOW) != 0) {
+        switch (errno) {
+        case EACCES: return StatError::ACCESS_DENIED;
+        case ENOENT: return StatError::NOT_FOUND;
+        default:     return StatError::IO_ERROR;
+        }
+    }
+
+    out->size = (uint64_t)st.st_size;
+    out->modified_time = (int64_t)st.st_mtime;
+    out->type = _entry_type_from_mode(st.st_mode);
+#elif OK_WINDOWS
+    OK_UNUSED(entry);
+
+    // FILETIME counts 100ns intervals since 1601
+    uint64_t write_time = ((uint64_t)data.ftLastWriteTime.dwHighDateTime << 32) | data.ftLastWriteTime.dwLowDateTime;
+
+    out->size = ((uint64_t)data.nFileSizeHigh << 32) | data.nFileSizeLow;
+    out->modified_time = ((int64_t)write_time - 116444736000000000ll) / 10000000;
+    out->type = _entry_type_from_attributes(data.dwFileAttributes);
+#endif // OK_UNIX
+
+    return {};
+}
+
+void DirectoryIterator::close() {
+#if OK_LINUX
+    ::close(fd);
+    fd = -1;
+#elif OK_UNIX
+    ::closedir(dir);
+    dir = nullptr;
+#elif OK_WINDOWS
+    ::FindClose(find);
+    find = INVALID_HANDLE_VALUE;
+#endif // OK_LINUX
+
+    if (buffer != nullptr) allocator->dealloc(buffer, capacity);
+    buffer = nullptr;
+    capacity = 0;
+}
+
+struct _WalkDirectory {
+    const char* path;
+    size_t length;
+    size_t depth;
+};
+
+struct _Walk {
+    DirectoryWalker::Visit visit;
+    void* user_data;
+    MpmcQueue<_WalkDirectory> queue;
+    // the paths of the queued directories, shared by all the threads
+    ConcurrentArenaAllocator paths;
+    // directories that were queued and are not fully listed yet
+    std::atomic<size_t> pending;
+};
+
+static void _walk_directory(_Walk* walk, ArenaAllocator* scratch, _WalkDirectory directory) {
+    // the listing buffer and the path go away together with the directory
+    Allocator::Scope scope{scratch};
+
+    DirectoryIterator it;
+    if (DirectoryIterator::open(&it, scratch, directory.path).has_value()) return;
+
+    auto path = List<char, ArenaAllocator>::alloc(scratch, directory.length + 256);
+    path.append_many(directory.path, directory.length);
+
+    char last = directory.length > 0 ? directory.path[directory.length - 1] : '/';
+    if (last != '/' && last != '\\') path.push('/');
+
+    size_t prefix = path.count;
+
+    for (;;) {
+        Optional<DirectoryIterator::Entry> listed;
+        if (it.next(&listed).has_value() || !listed.has_value()) break;
+
+        auto& entry = listed.get();
+        auto type = entry.type;
+
+        if (type == DirectoryIterator::EntryType::UNKNOWN) {
+            DirectoryIterator::Info info;
+            if (!it.stat(entry, &info).has_value()) type = info.type;
+        }
+
+        path.count = prefix;
+        path.append_many(entry.name.data, entry.name.count);
+        path.push('\0');
+
+        DirectoryWalker::Entry visited{
+            StringView{path.items, path.count - 1},
+            StringView{path.items + prefix, entry.name.count},
+            type,
+            directory.depth,
+        };
+
+        bool descend = walk->visit(walk->user_data, visited);
+        if (!descend || type != DirectoryIterator::EntryType::DIRECTORY) continue;
+
+        char* child_path = walk->paths.alloc<char>(path.count);
+        memcpy(child_path, path.items, path.count);
+
+        _WalkDirectory child{child_path, path.count - 1, directory.depth + 1};
+        walk->pending.fetch_add(1, std::memory_order_relaxed);
+
+        if (!walk->queue.push(child)) {
+            // the other threads have plenty to do, so this one goes depth first
+            walk->pending.fetch_sub(1, std::memory_order_relaxed);
+            _walk_directory(walk, scratch, child);
+        }
+    }
+
+    it.close();
+}
+
+static void _walk_worker(_Walk* walk) {
+    ArenaAllocator scratch{};
+    _WalkDirectory directory;
+
+    for (;;) {
+        if (walk->queue.pop(&directory)) {
+            _walk_directory(walk, &scratch, directory);
+            // the directory's children were counted before it is let go, so this only reaches 0 at the end
+            walk->pending.fetch_sub(1, std::memory_order_acq_rel);
+            continue;
+        }
+
+        if (walk->pending.load(std::memory_order_acquire) == 0) break;
+        std::this_thread::yield();
+    }
+
+    scratch.free();
+}
+
+Optional<DirectoryIterator::OpenError> DirectoryWalker::walk(const char* root, Visit visit, void* user_data,
+                                                             size_t thread_count) {
+    _Walk walk{};
+    walk.visit = visit;
+    walk.user_data = user_data;
+
+    // only the root reports its errors, the threads skip the directories they fail to open
+    DirectoryIterator it;
+    auto err = DirectoryIterator::open(&it, &walk.paths, root);
+    if (err.has_value()) return err;
+    it.close();
+
+    if (thread_count == 0) thread_count = max(std::thread::hardware_concurrency(), 1u);
+
+    MpmcQueue<_WalkDirectory>::init(&walk.queue, &walk.paths, QUEUE_CAPACITY);
+
+    walk.pending.store(1, std::memory_order_relaxed);
+    walk.queue.push(_WalkDirectory{root, strlen(root), 0});
+
+    auto threads = List<std::thread>::alloc(&walk.paths, thread_count);
+    for (size_t i = 1; i < thread_count; i++) threads.emplace(_walk_worker, &walk);
+
+    _walk_worker(&walk);
+
+    for (size_t i = 0; i < threads.count; i++) threads[i].join();
+
+    threads.free();
+    walk.queue.free();
+    walk.paths.free();
+
+    return {};
+}
+
+// ASYNC IO IMPLEMENTATION
+#if OK_IO_URING
+static bool _io_uring_init(AsyncIo::Ring* ring, uint32_t entries) {
+    io_uring_params params;
+    memset(&params, 0, sizeof(params));
+
+    int fd = (int)::syscall(__NR_io_uring_setup, entries, &params);
+    if (fd < 0) return false;
+
+    // IORING_OP_READ and IORING_OP_WRITE came together with this feature
+    if (!(params.features & IORING_FEAT_RW_CUR_POS)) {
+        ::close(fd);
+        return false;
+    }
+
+    ring->fd = fd;
+    ring->sq_mapping_size = params.sq_off.array + params.sq_entries * sizeof(uint32_t);
+    ring->cq_mapping_size = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+
+    bool single_mapping = params.features & IORING_FEAT_SINGLE_MMAP;
+    if (single_mapping) {
+        ring->sq_mapping_size = max(ring->sq_mapping_size, ring->cq_mapping_size);
+        ring->cq_mapping_size = ring->sq_mapping_size;
+    }
+
+    ring->sq_mapping = ::mmap(nullptr, ring->sq_mapping_size, PROT_READ | PROT_WRITE,
+                              MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_SQ_RING);
+    if (ring->sq_mapping == MAP_FAILED) {
+        ::close(fd);
+        return false;
+    }
+
+    if (single_mapping) {
+        ring->cq_mapping = ring->sq_mapping;
+    } else {
+        ring->cq_mapping = ::mmap(nullptr, ring->cq_mapping_size, PROT_READ | PROT_WRITE,
+                                  MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_CQ_RING);
+        if (ring->cq_mapping == MAP_FAILED) {
+            ::munmap(ring->sq_mapping, ring->sq_mapping_size);
+            ::close(fd);
+            return false;
+        }
+    }
+
+    ring->sqes_size = params.sq_entries * sizeof(io_uring_sqe);
+    ring->sqes = (io_uring_sqe*)::mmap(nullptr, ring->sqes_size, PROT_READ | PROT_WRITE,
+                                       MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_SQES);
+    if (ring->sqes == MAP_FAILED) {
+        if (!single_mapping) ::munmap(ring->cq_mapping, ring->cq_mapping_size);
+        ::munmap(ring->sq_mapping, ring->sq_mapping_size);
+        ::close(fd);
+        return false;
+    }
+
+    auto* sq = (uint8_t*)ring->sq_mapping;
+    ring->sq_head = (uint32_t*)(sq + params.sq_off.head);
+    ring->sq_tail = (uint32_t*)(sq + params.sq_off.tail);
+    ring->sq_mask = (uint32_t*)(sq + params.sq_off.ring_mask);
+    ring->sq_array = (uint32_t*)(sq + params.sq_off.array);
+
+    auto* cq = (uint8_t*)ring->cq_mapping;
+    ring->cq_head = (uint32_t*)(cq + params.cq_off.head);
+    ring->cq_tail = (uint32_t*)(cq + params.cq_off.tail);
+    ring->cq_mask = (uint32_t*)(cq + params.cq_off.ring_mask);
+    ring->cqes = (io_uring_cqe*)(cq + params.cq_off.cqes);
+
+    return true;
+}
+
+static void _io_uring_deinit(AsyncIo::Ring* ring) {
+    ::munmap(ring->sqes, ring->sqes_size);
+    if (ring->cq_mapping != ring->sq_mapping) ::munmap(ring->cq_mapping, ring->cq_mapping_size);
+    ::munmap(ring->sq_mapping, ring->sq_mapping_size);
+    ::close(ring->fd);
+}
+
+static inline int _io_uring_enter(int fd, uint32_t to_submit, uint32_t min_complete, uint32_t flags) {
+    return (int)::syscall(__NR_io_uring_enter, fd, to_submit, min_complete, flags, nullptr, 0);
+}
+#endif // OK_IO_URING
+
+Optional<AsyncIo::Error> AsyncIo::init(AsyncIo* out, Allocator* a, uint32_t entries) {
+    AsyncIo io{};
+    io.allocator = a;
+    io.entries = entries;
+    io.backend = Backend::BLOCKING;
+
+    io.queued = a->alloc<Request>(entries);
+    io.completed = a->alloc<Completion>(entries);
+    if (io.queued == nullptr || io.completed == nullptr) return Error::OUT_OF_MEMORY;
+
+#if OK_IO_URING
+    if (_io_uring_init(&io.ring, entries)) io.backend = Backend::IO_URING;
+#elif OK_WINDOWS
+    io.port = ::CreateIoCompletionPort(INVALID_HANDLE_VALUE, nullptr, 0, 1);
+
+    if (io.port != nullptr) {
+        io.backend = Backend::IOCP;
+        io.pending_pool = a->alloc<Pending>(entries);
+        io.handles = Table<int32_t, HANDLE>::alloc(a);
+
+        for (uint32_t i = 0; i < entries; i++) {
+            io.pending_pool[i].next_free = i + 1 < entries ? &io.pending_pool[i + 1] : nullptr;
+        }
+
+        io.free_pending = io.pending_pool;
+    }
+#endif // OK_IO_URING
+
+    *out = io;
+    return {};
+}
+
+void AsyncIo::deinit() {
+#if OK_IO_URING
+    if (backend == Backend::IO_URING) _io_uring_deinit(&ring);
+#elif OK_WINDOWS
+    if (backend == Backend::IOCP) {
+        OK_TABLE_FOREACH(handles, fd, handle, { OK_UNUSED(fd); ::CloseHandle(handle); });
+        handles.free();
+        allocator->dealloc(pending_pool, entries);
+        ::CloseHandle(port);
+    }
+#endif // OK_IO_URING
+
+    allocator->dealloc(completed, entries);
+    allocator->dealloc(queued, entries);
+}
+
+bool AsyncIo::queue_read(const File& file, uint8_t* buf, size_t count, uint64_t offset, uint64_t user_data) {
+    if (pending() + completed_count >= entries) return false;
+
+    queued[queued_count++] = Request{Op::READ, file.fd, buf, count, offset, user_data};
+    return true;
+}
+
+bool AsyncIo::queue_write(const File& file, const uint8_t* buf, size_t count, uint64_t offset, uint64_t user_data) {
+    if (pending() + completed_count >= entries) return false;
+
+    queued[queued_count++] = Request{Op::WRITE, file.fd, (uint8_t*)buf, count, offset, user_data};
+    return true;
+}
+
+static inline void _push_completion(AsyncIo* io, uint64_t user_data, int64_t result) {
+    uint32_t idx = (io->completed_head + io->completed_count) % io->entries;
+    io->completed[idx] = AsyncIo::Completion{user_data, result};
+    io->completed_count++;
+}
+
+static void _run_blocking(AsyncIo* io, const AsyncIo::Request& request) {
+    int64_t r;
+
+    do {
+        r = request.op == AsyncIo::Op::READ
+            ? ok::_pread(request.fd, request.buffer, request.count, request.offset)
+            : ok::_pwrite(request.fd, request.buffer, request.count, request.offset);
+    } while (r < 0 && errno == EINTR);
+
+    _push_completion(io, request.user_data, r < 0 ? -(int64_t)errno : r);
+}
+
+#if OK_WINDOWS
+static HANDLE _overlapped_handle(AsyncIo* io, int fd) {
+    HANDLE* cached = io->handles.get_ptr((int32_t)fd);
+    if (cached != nullptr) return *cached;
+
+    HANDLE handle = ::ReOpenFile((HANDLE)::_get_osfhandle(fd), GENERIC_READ | GENERIC_WRITE,
+                                 FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE, FILE_FLAG_OVERLAPPED);
+    if (handle == INVALID_HANDLE_VALUE) return handle;
+
+    if (::CreateIoCompletionPort(handle, io->port, 0, 0) == nullptr) {
+        ::CloseHandle(handle);
+        return INVALID_HANDLE_VALUE;
+    }
+
+    io->handles.put((int32_t)fd, handle);
+    return handle;
+}
+#endif // OK_WINDOWS
+
+Optional<AsyncIo::Error> AsyncIo::submit() {
+    if (queued_count == 0 && unsubmitted == 0) return {};
+
+    switch (backend) {
+    case Backend::BLOCKING: {
+        for (uint32_t i = 0; i < queued_count; i++) _run_blocking(this, queued[i]);
+        queued_count = 0;
+        return {};
+    }
+
+    case Backend::IO_URING: {
+#if OK_IO_URING
+        uint32_t tail = *ring.sq_tail;
+        uint32_t mask = *ring.sq_mask;
+
+        for (uint32_t i = 0; i < queued_count; i++) {
+            const Request& request = queued[i];
+            uint32_t idx = tail & mask;
+
+            io_uring_sqe* sqe = &ring.sqes[idx];
+            memset(sqe, 0, sizeof(*sqe));
+
+            sqe->opcode = request.op == Op::READ ? IORING_OP_READ : IORING_OP_WRITE;
+            sqe->fd = request.fd;
+            sqe->addr = (uint64_t)(uintptr_t)request.buffer;
+            sqe->len = (uint32_t)min(request.count, (size_t)0xFFFFFFFF);
+            sqe->off = request.offset;
+            sqe->user_data = request.user_data;
+
+            ring.sq_array[idx] = idx;
+            tail++;
+        }
+
+        __atomic_store_n(ring.sq_tail, tail, __ATOMIC_RELEASE);
+
+        // once published the entries belong to the ring, a retry must not write them again
+        unsubmitted += queued_count;
+        queued_count = 0;
+
+        while (unsubmitted > 0) {
+            int submitted = _io_uring_enter(ring.fd, unsubmitted, 0, 0);
+
+            if (submitted < 0) {
+                if (errno == EINTR) continue;
+                return Error::SUBMIT_FAILED;
+            }
+
+            unsubmitted -= (uint32_t)submitted;
+            in_flight += (uint32_t)submitted;
+        }
+
+        return {};
+#else
+        OK_UNREACHABLE();
+#endif // OK_IO_URING
+    }
+
+    case Backend::IOCP: {
+#if OK_WINDOWS
+        for (uint32_t i = 0; i < queued_count; i++) {
+            const Request& request = queued[i];
+            HANDLE handle = _overlapped_handle(this, request.fd);
+
+            if (handle == INVALID_HANDLE_VALUE) {
+                _push_completion(this, request.user_data, -EBADF);
+                continue;
+            }
+
+            Pending* pending = free_pending;
+            free_pending = pending->next_free;
+
+            memset(&pending->overlapped, 0, sizeof(pending->overlapped));
+            pending->overlapped.Offset = (DWORD)request.offset;
+            pending->overlapped.OffsetHigh = (DWORD)(request.offset >> 32);
+            pending->user_data = request.user_data;
+
+            DWORD count = (DWORD)min(request.count, (size_t)0xFFFFFFFF);
+            BOOL ok = request.op == Op::READ
+                ? ::ReadFile(handle, request.buffer, count, nullptr, &pending->overlapped)
+                : ::WriteFile(handle, request.buffer, count, nullptr, &pending->overlapped);
+
+            // requests that fail right away never reach the completion port
+            if (!ok && ::GetLastError() != ERROR_IO_PENDING) {
+                _push_completion(this, request.user_data, ::GetLastError() == ERROR_HANDLE_EOF ? 0 : -EIO);
+                pending->next_free = free_pending;
+                free_pending = pending;
+                continue;
+            }
+
+            in_flight++;
+        }
+
+        queued_count = 0;
+        return {};
+#else
+        OK_UNREACHABLE();
+#endif // OK_WINDOWS
+    }
+    }
+
+    OK_UNREACHABLE();
+}
+
+size_t AsyncIo::poll(Completion* out, size_t max_count) {
+    size_t n = 0;
+
+    while (completed_count > 0 && n < max_count) {
+        out[n++] = completed[completed_head];
+        completed_head = (completed_head + 1) % entries;
+        completed_count--;
+    }
+
+#if OK_IO_URING
+    if (backend == Backend::IO_URING) {
+        uint32_t head = *ring.cq_head;
+        uint32_t tail = __atomic_load_n(ring.cq_tail, __ATOMIC_ACQUIRE);
+        uint32_t mask = *ring.cq_mask;
+
+        while (head != tail && n < max_count) {
+            io_uring_cqe* cqe = &ring.cqes[head & mask];
+            out[n++] = Completion{cqe->user_data, cqe->res};
+            head++;
+            in_flight--;
+        }
+
+        __atomic_store_n(ring.cq_head, head, __ATOMIC_RELEASE);
+    }
+#elif OK_WINDOWS
+    if (backend == Backend::IOCP && in_flight > 0 && n < max_count) {
+        OVERLAPPED_ENTRY entries_buf[64];
+        ULONG removed = 0;
+        ULONG to_remove = (ULONG)min(max_count - n, (size_t)OK_ARR_LEN(entries_buf));
+
+        if (::GetQueuedCompletionStatusEx(port, entries_buf, to_remove, &removed, 0, FALSE)) {
+            for (ULONG i = 0; i < removed; i++) {
+                auto* pending = (Pending*)entries_buf[i].lpOverlapped;
+                bool failed = entries_buf[i].lpOverlapped->Internal != 0;
+
+                out[n++] = Completion{pending->user_data, failed ? -EIO : (int64_t)entries_buf[i].dwNumberOfBytesTransferred};
+
+                pending->next_free = free_pending;
+                free_pending = pending;
+                in_flight--;
+            }
+        }
+    }
+#endif // OK_IO_URING
+
+    return n;
+}
+
+Optional<AsyncIo::Error> AsyncIo::wait(Completion* out, size_t max_count, size_t min_count, size_t* count) {
+    OK_ASSERT(min_count <= max_count);
+
+    size_t n = poll(out, max_count);
+
+    while (n < min_count) {
+        if (in_flight == 0) break;
+
+#if OK_IO_URING
+        if (backend == Backend::IO_URING) {
+            int res = _io_uring_enter(ring.fd, 0, 1, IORING_ENTER_GETEVENTS);
+            if (res < 0 && errno != EINTR) return Error::WAIT_FAILED;
+        }
+#elif OK_WINDOWS
+        if (backend == Backend::IOCP) {
+            DWORD bytes;
+            ULONG_PTR key;
+            OVERLAPPED* overlapped;
+
+            BOOL ok = ::GetQueuedCompletionStatus(port, &bytes, &key, &overlapped, INFINITE);
+            if (overlapped == nullptr) return Error::WAIT_FAILED;
+
+            auto* pending = (Pending*)overlapped;
+            out[n++] = Completion{pending->user_data, ok ? (int64_t)bytes : -EIO};
+
+            pending->next_free = free_pending;
+            free_pending = pending;
+            in_flight--;
+            continue;
+        }
+#endif // OK_IO_URING
+
+        n += poll(out + n, max_count - n);
+    }
+
+    *count = n;
+    return {};
+}
+
+// NETWORK API IMPLEMENTATION
+#if OK_WINDOWS
+static void _init_winsock() {
+    static bool initialized = false;
+    if (initialized) return;
+
+    WSADATA data;
+    OK_ASSERT(::WSAStartup(MAKEWORD(2, 2), &data) == 0);
+    initialized = true;
+}
+
+static inline int _socket_errno() {
+    return ::WSAGetLastError();
+}
+
+static Socket::Error _to_socket_error(int error) {
+    using Error = Socket::Error;
+
+    switch (error) {
+    case WSAEWOULDBLOCK:
+    case WSAEINPROGRESS:    return Error::WOULD_BLOCK;
+    case WSAEACCES:         return Error::ACCESS_DENIED;
+    case WSAEADDRINUSE:     return Error::ADDRESS_IN_USE;
+    case WSAEADDRNOTAVAIL:  return Error::ADDRESS_NOT_AVAILABLE;
+    case WSAECONNREFUSED:   return Error::CONNECTION_REFUSED;
+    case WSAECONNRESET:     return Error::CONNECTION_RESET;
+    case WSAECONNABORTED:   return Error::CONNECTION_ABORTED;
+    case WSAENOTCONN:       return Error::NOT_CONNECTED;
+    case WSAESHUTDOWN:      return Error::BROKEN_PIPE;
+    case WSAETIMEDOUT:      return Error::TIMED_OUT;
+    case WSAENETUNREACH:    return Error::NETWORK_UNREACHABLE;
+    case WSAEHOSTUNREACH:   return Error::HOST_UNREACHABLE;
+    case WSAEMFILE:         return Error::TOO_MANY_OPEN_FILES;
+    case WSAENOBUFS:        return Error::OUT_OF_MEMORY;
+    case WSAEMSGSIZE:       return Error::MESSAGE_TOO_BIG;
+    default:                return Error::IO_ERROR;
+    }
+}
+#else
+static inline int _socket_errno() {
+    return errno;
+}
+
+static Socket::Error _to_socket_error(int error) {
+    using Error = Socket::Error;
+
+    switch (error) {
+#if EAGAIN != EWOULDBLOCK
+    case EWOULDBLOCK:
+#endif // EAGAIN != EWOULDBLOCK
+    case EAGAIN:
+    case EINPROGRESS:   return Error::WOULD_BLOCK;
+    case EACCES:
+    case EPERM:         return Error::ACCESS_DENIED;
+    case EADDRINUSE:    return Error::ADDRESS_IN_USE;
+    case EADDRNOTAVAIL: return Error::ADDRESS_NOT_AVAILABLE;
+    case ECONNREFUSED:  return Error::CONNECTION_REFUSED;
+    case ECONNRESET:    return Error::CONNECTION_RESET;
+    case ECONNABORTED:  return Error::CONNECTION_ABORTED;
+    case ENOTCONN:      return Error::NOT_CONNECTED;
+    case EPIPE:         return Error::BROKEN_PIPE;
+    case ETIMEDOUT:     return Error::TIMED_OUT;
+    case ENETUNREACH:   return Error::NETWORK_UNREACHABLE;
+    case EHOSTUNREACH:  return Error::HOST_UNREACHABLE;
+    case EMFILE:
+    case ENFILE:        return Error::TOO_MANY_OPEN_FILES;
+    case ENOMEM:
+    case ENOBUFS:       return Error::OUT_OF_MEMORY;
+    case EMSGSIZE:      return Error::MESSAGE_TOO_BIG;
+    default:            return Error::IO_ERROR;
+    }
+}
+#endif // OK_WINDOWS
+
+#if !OK_LINUX
+static bool _set_nonblocking(Socket::Handle handle) {
+#if OK_WINDOWS
+    u_long enabled = 1;
+    return ::ioctlsocket(handle, FIONBIO, &enabled) == 0;
+#else
+    int flags = ::fcntl(handle, F_GETFL, 0);
+    if (flags < 0) return false;
+
+    return ::fcntl(handle, F_SETFL, flags | O_NONBLOCK) == 0
+        && ::fcntl(handle, F_SETFD, FD_CLOEXEC) == 0;
+#endif // OK_WINDOWS
+}
+#endif // !OK_LINUX
+
+static inline void _close_socket(Socket::Handle handle) {
+#if OK_WINDOWS
+    ::closesocket(handle);
+#else
+    ::close(handle);
+#endif // OK_WINDOWS
+}
+
+Optional<Address::ParseError> Address::parse(Address* out, const char* ip, uint16_t port) {
+#if OK_WINDOWS
+    _init_winsock();
+#endif // OK_WINDOWS
+
+    Address address{};
+
+    auto* v4 = (sockaddr_in*)&address.storage;
+    if (::inet_pton(AF_INET, ip, &v4->sin_addr) == 1) {
+        v4->sin_family = AF_INET;
+        v4->sin_port = htons(port);
+        address.length = sizeof(sockaddr_in);
+
+        *out = address;
+        return {};
+    }
+
+    auto* v6 = (sockaddr_in6*)&address.storage;
+    if (::inet_pton(AF_INET6, ip, &v6->sin6_addr) == 1) {
+        v6->sin6_family = AF_INET6;
+        v6->sin6_port = htons(port);
+        address.length = sizeof(sockaddr_in6);
+
+        *out = address;
+        return {};
+    }
+
+    return ParseError::INVALID_ADDRESS;
+}
+
+static Address _ipv4_address(uint32_t host, uint16_t port) {
+    Address address{};
+
+    auto* v4 = (sockaddr_in*)&address.storage;
+    v4->sin_family = AF_INET;
+    v4->sin_port = htons(port);
+    v4->sin_addr.s_addr = htonl(host);
+    address.length = sizeof(sockaddr_in);
+
+    return address;
+}
+
+Address Address::loopback(uint16_t port) {
+    return _ipv4_address(INADDR_LOOPBACK, port);
+}
+
+Address Address::any(uint16_t port) {
+    return _ipv4_address(INADDR_ANY, port);
+}
+
+uint16_t Address::port() const {
+    if (is_ipv6()) return ntohs(((const sockaddr_in6*)&storage)->sin6_port);
+    return ntohs(((const sockaddr_in*)&storage)->sin_port);
+}
+
+Optional<Socket::Error> Socket::open(Socket* out, bool ipv6, Type type) {
+#if OK_WINDOWS
+    _init_winsock();
+#endif // OK_WINDOWS
+
+    int family = ipv6 ? AF_INET6 : AF_INET;
+    int sock_type = type == Type::TCP ? SOCK_STREAM : SOCK_DGRAM;
+
+#if OK_LINUX
+    Handle handle = ::socket(family, sock_type | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if (handle == INVALID_HANDLE) return _to_socket_error(_socket_errno());
+#else
+    Handle handle = ::socket(family, sock_type, 0);
+    if (handle == INVALID_HANDLE) return _to_socket_error(_socket_errno());
+
+    if (!_set_nonblocking(handle)) {
+        int error = _socket_errno();
+        _close_socket(handle);
+        return _to_socket_error(error);
+    }
+#endif // OK_LINUX
+
+#ifdef SO_NOSIGPIPE
+    int enabled = 1;
+    ::setsockopt(handle, SOL_SOCKET, SO_NOSIGPIPE, &enabled, sizeof(enabled));
+#endif // SO_NOSIGPIPE
+
+    out->handle = handle;
+    return {};
+}
+
+Optional<Socket::Error> Socket::listen(Socket* out, const Address& address, Type type, int backlog) {
+    Socket socket;
+    auto err = Socket::open(&socket, address.is_ipv6(), type);
+    if (err.has_value()) return err;
+
+    int enabled = 1;
+    ::setsockopt(socket.handle, SOL_SOCKET, SO_REUSEADDR, (const char*)&enabled, sizeof(enabled));
+
+    if (::bind(socket.handle, (const sockaddr*)&address.storage, (int)address.length) != 0
+        || (type == Type::TCP && ::listen(socket.handle, backlog) != 0)) {
+        int error = _socket_errno();
+        socket.close();
+        return _to_socket_error(error);
+    }
+
+    *out = socket;
+    return {};
+}
+
+Optional<Socket::Error> Socket::connect(Socket* out, const Address& address, Type type) {
+    Socket socket;
+    auto err = Socket::open(&socket, address.is_ipv6(), type);
+    if (err.has_value()) return err;
+
+    int r;
+    do {
+        r = ::connect(socket.handle, (const sockaddr*)&address.storage, (int)address.length);
+    } while (r != 0 && _socket_errno() == EINTR);
+
+    if (r != 0) {
+        int error = _socket_errno();
+        Socket::Error socket_error = _to_socket_error(error);
+
+        // the connection is still being established
+        if (socket_error != Socket::Error::WOULD_BLOCK) {
+            socket.close();
+            return socket_error;
+        }
+    }
+
+    *out = socket;
+    return {};
+}
+
+Optional<Socket::Error> Socket::connect_result() const {
+    int error = 0;
+#if OK_WINDOWS
+    int length = sizeof(error);
+#else
+    socklen_t length = sizeof(error);
+#endif // OK_WINDOWS
+
+    if (::getsockopt(handle, SOL_SOCKET, SO_ERROR, (char*)&error, &length) != 0) {
+        return _to_socket_error(_socket_errno());
+    }
+
+    if (error != 0) return _to_socket_error(error);
+    return {};
+}
+
+Optional<Socket::Error> Socket::accept(Socket* out, Address* peer) const {
+    Address address{};
+#if OK_WINDOWS
+    int length = sizeof(address.storage);
+#else
+    socklen_t length = sizeof(address.storage);
+#endif // OK_WINDOWS
+
+    Handle client;
+
+    do {
+#if OK_LINUX
+        client = ::accept4(handle, (sockaddr*)&address.storage, &length, SOCK_NONBLOCK | SOCK_CLOEXEC);
+#else
+        client = ::accept(handle, (sockaddr*)&address.storage, &length);
+#endif // OK_LINUX
+    } while (client == INVALID_HANDLE && _socket_errno() == EINTR);
+
+    if (client == INVALID_HANDLE) return _to_socket_error(_socket_errno());
+
+#if !OK_LINUX
+    if (!_set_nonblocking(client)) {
+        int error = _socket_errno();
+        _close_socket(client);
+        return _to_socket_error(error);
+    }
+#endif // !OK_LINUX
+
+#ifdef SO_NOSIGPIPE
+    int enabled = 1;
+    ::setsockopt(client, SOL_SOCKET, SO_NOSIGPIPE, &enabled, sizeof(enabled));
+#endif // SO_NOSIGPIPE
+
+    address.length = (uint32_t)length;
+    if (peer != nullptr) *peer = address;
+
+    out->handle = client;
+    return {};
+}
+
+#ifdef MSG_NOSIGNAL
+#define OK_SEND_FLAGS MSG_NOSIGNAL
+#else
+#define OK_SEND_FLAGS 0
+#endif // MSG_NOSIGNAL
+
+#if OK_WINDOWS
+// winsock takes int lengths
+#define OK_SOCKET_IO_SIZE(count) ((int)min((count), (size_t)0x7FFFFFFF))
+#else
+#define OK_SOCKET_IO_SIZE(count) (count)
+#endif // OK_WINDOWS
+
+Optional<Socket::Error> Socket::read(uint8_t* buf, size_t count, size_t* bytes_read) const {
+    int64_t r;
+
+    do {
+        r = ::recv(handle, (char*)buf, OK_SOCKET_IO_SIZE(count), 0);
+    } while (r < 0 && _socket_errno() == EINTR);
+
+    if (r < 0) return _to_socket_error(_socket_errno());
+
+    *bytes_read = (size_t)r;
+    return {};
+}
+
+Optional<Socket::Error> Socket::write(const uint8_t* buf, size_t count, size_t* bytes_written) const {
+    int64_t r;
+
+    do {
+        r = ::send(handle, (const char*)buf, OK_SOCKET_IO_SIZE(count), OK_SEND_FLAGS);
+    } while (r < 0 && _socket_errno() == EINTR);
+
+    if (r < 0) return _to_socket_error(_socket_errno());
+
+    *bytes_written = (size_t)r;
+    return {};
+}
+
+Optional<Socket::Error> Socket::recv_from(uint8_t* buf, size_t count, Address* from, size_t* bytes_read) const {
+    Address address{};
+#if OK_WINDOWS
+    int length = sizeof(address.storage);
+#else
+    socklen_t length = sizeof(address.storage);
+#endif // OK_WINDOWS
+
+    int64_t r;
+
+    do {
+        r = ::recvfrom(handle, (char*)buf, OK_SOCKET_IO_SIZE(count), 0, (sockaddr*)&address.storage, &length);
+    } while (r < 0 && _socket_errno() == EINTR);
+
+    if (r < 0) return _to_socket_error(_socket_errno());
+
+    address.length = (uint32_t)length;
+    if (from != nullptr) *from = address;
+
+    *bytes_read = (size_t)r;
+    return {};
+}
+
+Optional<Socket::Error> Socket::send_to(const uint8_t* buf, size_t count, const Address& to, size_t* bytes_written) const {
+    int64_t r;
+
+    do {
+        r = ::sendto(handle, (const char*)buf, OK_SOCKET_IO_SIZE(count), OK_SEND_FLAGS,
+                     (const sockaddr*)&to.storage, (int)to.length);
+    } while (r < 0 && _socket_errno() == EINTR);
+
+    if (r < 0) return _to_socket_error(_socket_errno());
+
+    *bytes_written = (size_t)r;
+    return {};
+}
+
+#undef OK_SOCKET_IO_SIZE
+#undef OK_SEND_FLAGS
+
+Optional<Socket::Error> Socket::local_address(Address* out) const {
+    Address address{};
+#if OK_WINDOWS
+    int length = sizeof(address.storage);
+#else
+    socklen_t length = sizeof(address.storage);
+#endif // OK_WINDOWS
+
+    if (::getsockname(handle, (sockaddr*)&address.storage, &length) != 0) return _to_socket_error(_socket_errno());
+
+    address.length = (uint32_t)length;
+    *out = address;
+    return {};
+}
+
+Optional<Socket::Error> Socket::set_nodelay(bool enabled) const {
+    int value = enabled;
+    if (::setsockopt(handle, IPPROTO_TCP, TCP_NODELAY, (const char*)&value, sizeof(value)) != 0) {
+        return _to_socket_error(_socket_errno());
+    }
+
+    return {};
+}
+
+void Socket::close() {
+    if (handle == INVALID_HANDLE) return;
+
+    _close_socket(handle);
+    handle = INVALID_HANDLE;
+}
+
+#if OK_LINUX
+static inline uint32_t _epoll_events(uint8_t interest) {
+    uint32_t events = EPOLLET | EPOLLRDHUP;
+    if (interest & EventLoop::READABLE) events |= EPOLLIN;
+    if (interest & EventLoop::WRITABLE) events |= EPOLLOUT;
+    return events;
+}
+
+static EventLoop::Error _to_event_loop_error(int error) {
+    using Error = EventLoop::Error;
+
+    switch (error) {
+    case EMFILE:
+    case ENFILE: return Error::TOO_MANY_OPEN_FILES;
+    case ENOSPC:
+    case ENOMEM: return Error::OUT_OF_MEMORY;
+    case EEXIST: return Error::ALREADY_REGISTERED;
+    case ENOENT: return Error::NOT_REGISTERED;
+    case EPERM:  return Error::UNSUPPORTED_HANDLE;
+    case EBADF:
+    case EINVAL: return Error::INVALID_HANDLE;
+    default:     OK_PANIC_FMT("Unexpected epoll error: %s", strerror(error));
+    }
+}
+
+Optional<EventLoop::Error> EventLoop::init(EventLoop* out, Allocator* a) {
+    int fd = ::epoll_create1(EPOLL_CLOEXEC);
+    if (fd < 0) return _to_event_loop_error(errno);
+
+    out->allocator = a;
+    out->fd = fd;
+    return {};
+}
+
+void EventLoop::deinit() {
+    ::close(fd);
+}
+
+Optional<EventLoop::Error> EventLoop::add(const Socket& socket, uint8_t interest, void* user_data) {
+    epoll_event event{};
+    event.events = _epoll_events(interest);
+    event.data.ptr = user_data;
+
+    if (::epoll_ctl(fd, EPOLL_CTL_ADD, socket.handle, &event) != 0) return _to_event_loop_error(errno);
+    return {};
+}
+
+Optional<EventLoop::Error> EventLoop::modify(const Socket& socket, uint8_t interest, void* user_data) {
+    epoll_event event{};
+    event.events = _epoll_events(interest);
+    event.data.ptr = user_data;
+
+    if (::epoll_ctl(fd, EPOLL_CTL_MOD, socket.handle, &event) != 0) return _to_event_loop_error(errno);
+    return {};
+}
+
+void EventLoop::remove(const Socket& socket) {
+    epoll_event event{};
+    ::epoll_ctl(fd, EPOLL_CTL_DEL, socket.handle, &event);
+}
+
+Optional<EventLoop::Error> EventLoop::wait(Event* out, size_t max_count, int timeout_ms, size_t* count) {
+    epoll_event events[MAX_EVENTS_PER_WAIT];
+    int n = ::epoll_wait(fd, events, (int)min(max_count, MAX_EVENTS_PER_WAIT), timeout_ms);
+
+    if (n < 0) {
+        if (errno != EINTR) return Error::WAIT_FAILED;
+        n = 0;
+    }
+
+    for (int i = 0; i < n; i++) {
+        uint8_t flags = 0;
+        if (events[i].events & EPOLLIN) flags |= READABLE;
+        if (events[i].events & EPOLLOUT) flags |= WRITABLE;
+        if (events[i].events & (EPOLLHUP | EPOLLRDHUP)) flags |= HANGUP;
+        if (events[i].events & EPOLLERR) flags |= ERRORED;
+
+        out[i] = Event{events[i].data.ptr, flags};
+    }
+
+    *count = (size_t)n;
+    return {};
+}
+#elif OK_KQUEUE
+static EventLoop::Error _to_event_loop_error(int error) {
+    using Error = EventLoop::Error;
+
+    switch (error) {
+    case EMFILE:
+    case ENFILE: return Error::TOO_MANY_OPEN_FILES;
+    case ENOMEM: return Error::OUT_OF_MEMORY;
+    case ENOENT: return Error::NOT_REGISTERED;
+    case ENODEV: return Error::UNSUPPORTED_HANDLE;
+    case EBADF:
+    case EINVAL: return Error::INVALID_HANDLE;
+    default:     OK_PANIC_FMT("Unexpected kqueue error: %s", strerror(error));
+    }
+}
 
-            _init_region(region, region_size);
+static Optional<EventLoop::Error> _kqueue_register(int kq, const Socket& socket, uint8_t interest, void* user_data) {
+    struct kevent changes[2];
+    unsigned short read_flags = EV_ADD | EV_CLEAR | (interest & EventLoop::READABLE ? EV_ENABLE : EV_DISABLE);
+    unsigned short write_flags = EV_ADD | EV_CLEAR | (interest & EventLoop::WRITABLE ? EV_ENABLE : EV_DISABLE);
 
-            current_region->off += align_to(sizeof(Region), sizeof(void*));
+    EV_SET(&changes[0], socket.handle, EVFILT_READ, read_flags, 0, 0, user_data);
+    EV_SET(&changes[1], socket.handle, EVFILT_WRITE, write_flags, 0, 0, user_data);
 
-            return region;
-        }
+    if (::kevent(kq, changes, 2, nullptr, 0, nullptr) != 0) return _to_event_loop_error(errno);
+    return {};
+}
 
-        current_region = current_region->next;
-    }
+Optional<EventLoop::Error> EventLoop::init(EventLoop* out, Allocator* a) {
+    int kq = ::kqueue();
+    if (kq < 0) return _to_event_loop_error(errno);
 
-    current_region = (Region*)OK_ALLOC_SMOL(sizeof(Region));
+    out->allocator = a;
+    out->fd = kq;
+    return {};
+}
 
-    current_region->data = OK_ALLOC_PAGE(OK_PAGE_SIZE);
-    current_region->size = OK_PAGE_SIZE;
-    current_region->off = align_to(sizeof(Region), sizeof(void*));
-    current_region->next = region_pool;
+void EventLoop::deinit() {
+    ::close(fd);
+}
 
-    this->region_pool = current_region;
+Optional<EventLoop::Error> EventLoop::add(const Socket& socket, uint8_t interest, void* user_data) {
+    return _kqueue_register(fd, socket, interest, user_data);
+}
 
-    auto* resulting_region = (Region*)current_region->data;
-    _init_region(resulting_region, region_size);
-    return resulting_region;
+Optional<EventLoop::Error> EventLoop::modify(const Socket& socket, uint8_t interest, void* user_data) {
+    return _kqueue_register(fd, socket, interest, user_data);
 }
 
-void* ArenaAllocator::raw_alloc(size_t size) {
-    ArenaAllocator::Region* region_head = this->head;
+void EventLoop::remove(const Socket& socket) {
+    struct kevent changes[2];
+    EV_SET(&changes[0], socket.handle, EVFILT_READ, EV_DELETE, 0, 0, nullptr);
+    EV_SET(&changes[1], socket.handle, EVFILT_WRITE, EV_DELETE, 0, 0, nullptr);
+    ::kevent(fd, changes, 2, nullptr, 0, nullptr);
+}
 
-    size = align_to(size, sizeof(void*));
+Optional<EventLoop::Error> EventLoop::wait(Event* out, size_t max_count, int timeout_ms, size_t* count) {
+    struct kevent events[MAX_EVENTS_PER_WAIT];
+    timespec timeout;
+    timeout.tv_sec = timeout_ms / 1000;
+    timeout.tv_nsec = (long)(timeout_ms % 1000) * 1'000'000;
 
-    while (region_head) {
-        if (region_head->size - region_head->off >= size) {
-            void* ptr = (void*)((uint8_t*)region_head->data + region_head->off);
-            region_head->off += size;
-            return ptr;
-        }
+    int n = ::kevent(fd, nullptr, 0, events, (int)min(max_count, MAX_EVENTS_PER_WAIT),
+                     timeout_ms < 0 ? nullptr : &timeout);
 
-        region_head = region_head->next;
+    if (n < 0) {
+        if (errno != EINTR) return Error::WAIT_FAILED;
+        n = 0;
     }
 
-    size_t region_size = align_to(size, OK_PAGE_ALIGN);
-    region_head = alloc_region(region_size);
-    region_head->next = this->head;
-    this->head = region_head;
+    for (int i = 0; i < n; i++) {
+        uint8_t flags = events[i].filter == EVFILT_READ ? READABLE : WRITABLE;
+        if (events[i].flags & EV_EOF) flags |= HANGUP;
+        if (events[i].flags & EV_ERROR) flags |= ERRORED;
 
-    void* ptr = (void*)((uint8_t*)region_head->data + region_head->off);
-    region_head->off += size;
-    return ptr;
-}
+        out[i] = Event{events[i].udata, flags};
+    }
 
-void ArenaAllocator::raw_dealloc(void* ptr, size_t size) {
-    OK_UNUSED(ptr);
-    OK_UNUSED(size);
+    *count = (size_t)n;
+    return {};
+}
+#else
+static inline short _poll_events(uint8_t interest) {
+    short events = 0;
+    if (interest & EventLoop::READABLE) events |= POLLIN;
+    if (interest & EventLoop::WRITABLE) events |= POLLOUT;
+    return events;
 }
 
-void* ArenaAllocator::raw_resize(void* old_ptr, size_t old_size, size_t new_size) {
-    auto* new_ptr = raw_alloc(new_size);
-    memcpy(new_ptr, old_ptr, old_size);
-    return new_ptr;
+static size_t _find_poll_fd(const EventLoop& loop, Socket::Handle handle) {
+    for (size_t i = 0; i < loop.fds.count; i++) {
+        if (loop.fds[i].fd == handle) return i;
+    }
+
+    return (size_t)-1;
 }
 
-// STRING IMPLEMENTATION
+Optional<EventLoop::Error> EventLoop::init(EventLoop* out, Allocator* a) {
+#if OK_WINDOWS
+    _init_winsock();
+#endif // OK_WINDOWS
 
-String String::alloc(Allocator* a, size_t capacity) {
-    String s;
-    s.data = List<char>::alloc(a, capacity + 1);
-    s.data.push(NULL_CHAR);
+    out->allocator = a;
+    out->fds = List<PollFd>::alloc(a);
+    out->user_datas = List<void*>::alloc(a);
+    return {};
+}
 
-    return s;
+void EventLoop::deinit() {
+    allocator->dealloc(fds.items, fds.capacity);
+    allocator->dealloc(user_datas.items, user_datas.capacity);
 }
 
-String String::alloc(Allocator* a, const char* data, size_t data_len) {
-    auto s = String::alloc(a, data_len);
+Optional<EventLoop::Error> EventLoop::add(const Socket& socket, uint8_t interest, void* user_data) {
+    if (_find_poll_fd(*this, socket.handle) != (size_t)-1) return Error::ALREADY_REGISTERED;
 
-    for (size_t i = 0; i < data_len; i++) s.push((char)data[i]);
+    PollFd pfd{};
+    pfd.fd = socket.handle;
+    pfd.events = _poll_events(interest);
 
-    return s;
+    fds.push(pfd);
+    user_datas.push(user_data);
+    return {};
 }
 
-String String::alloc(Allocator* a, const char* data) {
-    size_t data_len = strlen((const char*)data);
-    return String::alloc(a, data, data_len);
-}
+Optional<EventLoop::Error> EventLoop::modify(const Socket& socket, uint8_t interest, void* user_data) {
+    size_t idx = _find_poll_fd(*this, socket.handle);
+    if (idx == (size_t)-1) return Error::NOT_REGISTERED;
 
-String String::from(List<char> chars) {
-    String s;
-    s.data = chars;
-    s.data.push('\0');
-    return s;
+    fds[idx].events = _poll_events(interest);
+    user_datas[idx] = user_data;
+    return {};
 }
 
-String String::from(List<uint8_t> bytes) {
-    List<char> chars = bytes.cast<char>();
-    return String::from(chars);
+void EventLoop::remove(const Socket& socket) {
+    size_t idx = _find_poll_fd(*this, socket.handle);
+    if (idx == (size_t)-1) return;
+
+    fds.remove_at(idx);
+    user_datas.remove_at(idx);
 }
 
-String String::format(Allocator* a, const char* fmt, ...) {
-    va_list sprintf_args;
+Optional<EventLoop::Error> EventLoop::wait(Event* out, size_t max_count, int timeout_ms, size_t* count) {
+    *count = 0;
+    if (fds.count == 0) return {};
 
-    int buf_size;
-    va_start(sprintf_args, fmt);
-    {
-        char* sprintf_buf = nullptr;
-        buf_size = vsnprintf(sprintf_buf, 0, fmt, sprintf_args);
-        OK_ASSERT(buf_size != -1);
+#if OK_WINDOWS
+    int n = ::WSAPoll(fds.items, (ULONG)fds.count, timeout_ms);
+#else
+    int n = ::poll(fds.items, (nfds_t)fds.count, timeout_ms);
+#endif // OK_WINDOWS
 
-        buf_size += 1;
+    if (n < 0) {
+        if (_socket_errno() == EINTR) return {};
+        return Error::WAIT_FAILED;
     }
-    va_end(sprintf_args);
 
-    auto buf = String::alloc(a, buf_size);
+    size_t result = 0;
 
-    va_start(sprintf_args, fmt);
-    {
-        int bytes_written = vsnprintf((char*)buf.data.items, buf_size, fmt, sprintf_args);
-        OK_ASSERT(bytes_written != -1);
-    }
-    va_end(sprintf_args);
+    for (size_t i = 0; i < fds.count && result < max_count; i++) {
+        short revents = fds[i].revents;
+        if (revents == 0) continue;
 
-    buf.data.count = buf_size;
+        uint8_t flags = 0;
+        if (revents & POLLIN) flags |= READABLE;
+        if (revents & POLLOUT) flags |= WRITABLE;
+        if (revents & POLLHUP) flags |= HANGUP;
+        if (revents & (POLLERR | POLLNVAL)) flags |= ERRORED;
 
-    return buf;
-}
+        out[result++] = Event{user_datas[i], flags};
+    }
 
-void String::append(StringView sv) {
-    for (size_t i = 0; i < sv.count; ++i) push(sv.data[i]);
+    *count = result;
+    return {};
 }
+#endif // OK_LINUX
 
-void String::append(String str) {
-    size_t str_count = str.count();
-    for (size_t i = 0; i < str_count; ++i) push(str.data.items[i]);
+void Connection::init(Connection* out, Socket socket) {
+    *out = Connection{};
+    out->socket = socket;
 }
 
-void String::format_append(const char* fmt, ...) {
-    va_list sprintf_args;
+Optional<Socket::Error> Connection::receive() {
+    while (true) {
+        if (capacity - count < DEFAULT_READ_SIZE / 4) {
+            size_t new_capacity = max(capacity * 2, DEFAULT_READ_SIZE);
 
-    int required_buf_size;
-    va_start(sprintf_args, fmt);
-    {
-        char* sprintf_buf = nullptr;
-        required_buf_size = vsnprintf(sprintf_buf, 0, fmt, sprintf_args);
-        OK_ASSERT(required_buf_size != -1);
+            buffer = buffer == nullptr
+                ? arena.alloc<uint8_t>(new_capacity)
+                : arena.resize(buffer, capacity, new_capacity);
+            capacity = new_capacity;
+        }
+
+        size_t n;
+        auto err = socket.read(buffer + count, capacity - count, &n);
+
+        if (err.has_value()) {
+            if (err.get() == Socket::Error::WOULD_BLOCK) return {};
+            return err;
+        }
+
+        if (n == 0) {
+            peer_closed = true;
+            return {};
+        }
+
+        count += n;
     }
-    va_end(sprintf_args);
+}
 
-    size_t bytes_needed = count() + required_buf_size;
-    reserve(bytes_needed);
+void Connection::consume(size_t n) {
+    OK_ASSERT(start + n <= count);
+    start += n;
 
-    va_start(sprintf_args, fmt);
-    {
-        char* buf = (char*)data.items + count();
-        int bytes_written = vsnprintf(buf, required_buf_size + 1, fmt, sprintf_args);
-        OK_ASSERT(bytes_written != -1);
+    // nothing is left to read, so the buffer can be filled from the beginning again
+    if (start == count) {
+        start = 0;
+        count = 0;
     }
-    va_end(sprintf_args);
+}
+
+// PROCEDURES IMPLEMENTATION
+static const char _DIGIT_PAIRS[] =
+    "00010203040506070809"
+    "10111213141516171819"
+    "20212223242526272829"
+    "30313233343536373839"
+    "40414243444546474849"
+    "50515253545556575859"
+    "60616263646566676869"
+    "70717273747576777879"
+    "80818283848586878889"
+    "90919293949596979899";
+
+static const uint64_t _POWERS_OF_10[] = {
+    1ull,
+    10ull,
+    100ull,
+    1000ull,
+    10000ull,
+    100000ull,
+    1000000ull,
+    10000000ull,
+    100000000ull,
+    1000000000ull,
+    10000000000ull,
+    100000000000ull,
+    1000000000000ull,
+    10000000000000ull,
+    100000000000000ull,
+    1000000000000000ull,
+    10000000000000000ull,
+    100000000000000000ull,
+    1000000000000000000ull,
+    10000000000000000000ull,
+};
 
-    data.count += required_buf_size;
+// 1233 / 4096 approximates log10(2), the guess is off by at most one.
+// Zero is counted as one digit by treating it like 1
+static inline size_t _count_digits(uint64_t value) {
+    value |= 1;
+
+    uint32_t bits = 64 - count_leading_zeros(value);
+    uint32_t guess = (bits * 1233) >> 12;
+    return guess + 1 - (value < _POWERS_OF_10[guess]);
 }
 
-bool String::starts_with(StringView prefix) {
-    if (count() < prefix.count) return false;
+size_t to_chars(char* buf, uint64_t value) {
+    size_t n = _count_digits(value);
+    char* p = buf + n;
 
-    for (size_t i = 0; i < prefix.count; i++) {
-        if (data.items[i] != prefix.data[i]) return false;
+    while (value >= 100) {
+        size_t pair = (size_t)(value % 100) * 2;
+        value /= 100;
+        p -= 2;
+        memcpy(p, _DIGIT_PAIRS + pair, 2);
     }
 
-    return true;
+    if (value >= 10) {
+        p -= 2;
+        memcpy(p, _DIGIT_PAIRS + value * 2, 2);
+    } else {
+        *--p = (char)('0' + value);
+    }
+
+    return n;
 }
 
-// STRING VIEW IMPLEMENTATION
-bool StringView::operator ==(const String& string) const {
-    return *this == string.view();
+size_t to_chars(char* buf, int64_t value) {
+    if (value >= 0) return to_chars(buf, (uint64_t)value);
+
+    buf[0] = '-';
+    return 1 + to_chars(buf + 1, (uint64_t)0 - (uint64_t)value);
 }
 
-String StringView::to_string(Allocator* a) const {
-    return String::alloc(a, data, count);
+size_t to_chars(char* buf, uint32_t value) {
+    return to_chars(buf, (uint64_t)value);
 }
 
-// FILESYSTEM API IMPLEMENTATION
-Optional<File::OpenError> File::open(File* out, const char* path) {
-#if OK_UNIX
-    int fd = ::open(path, O_RDWR);
-    int error = errno;
-#elif OK_WINDOWS
-    int fd;
-    errno_t error = ::_sopen_s(&fd, path, _O_RDWR, _SH_DENYNO, 0);
-#endif // OK_UNIX
+size_t to_chars(char* buf, int32_t value) {
+    return to_chars(buf, (int64_t)value);
+}
 
-    if (fd < 0) {
-        switch (error) {
-        case EACCES:       return OpenError::ACCESS_DENIED;
-        case EINVAL:       return OpenError::INVALID_PATH;
-        case EISDIR:       return OpenError::IS_DIRECTORY;
-        case ELOOP:        return OpenError::TOO_MANY_SYMLINKS;
-        case EMFILE:       return OpenError::PROCESS_OPEN_FILES_LIMIT_REACHED;
-        case ENFILE:       return OpenError::SYSTEM_OPEN_FILES_LIMIT_REACHED;
-        case ENAMETOOLONG: return OpenError::PATH_TOO_LONG;
-        case ENOMEM:       return OpenError::KERNEL_OUT_OF_MEMORY;
-        case ENOSPC:       return OpenError::OUT_OF_SPACE;
-        case ENXIO:        return OpenError::IS_SOCKET;
-        case EOVERFLOW:    return OpenError::FILE_TOO_BIG;
-        case EROFS:        return OpenError::READONLY_FILE;
-        case EFAULT:       OK_PANIC_FMT("Parameter 'path' (%p) is not mapped to the current process", path);
-        default:           OK_UNREACHABLE();
+// Integral values are printed as integers, everything else is printed with the fewest
+// significant digits (15 to 17) that still round trip
+size_t to_chars(char* buf, double value) {
+    if (std::isnan(value)) {
+        memcpy(buf, "nan", 3);
+        return 3;
+    }
+
+    if (std::isinf(value)) {
+        if (value < 0) {
+            memcpy(buf, "-inf", 4);
+            return 4;
         }
+
+        memcpy(buf, "inf", 3);
+        return 3;
     }
 
-    out->fd = fd;
-    out->path = path;
+    if (std::fabs(value) < 9007199254740992.0 && value == (double)(int64_t)value) {
+        if (value == 0 && std::signbit(value)) {
+            memcpy(buf, "-0", 2);
+            return 2;
+        }
 
-    return {};
-}
+        return to_chars(buf, (int64_t)value);
+    }
 
-static inline off_t _lseek(int fd, off_t offset, int whence) {
-#if OK_UNIX
-    return ::lseek(fd, offset, whence);
-#elif OK_WINDOWS
-    return ::_lseek(fd, offset, whence);
-#endif // OK_UNIX
+#if OK_FLOAT_CHARCONV
+    auto result = std::to_chars(buf, buf + MAX_DOUBLE_CHARS, value);
+    OK_ASSERT(result.ec == std::errc{});
+    return (size_t)(result.ptr - buf);
+#else
+    char tmp[MAX_DOUBLE_CHARS];
+    int n = 0;
+
+    // snprintf and strtod agree on the locale's decimal point, so the probing works in any locale
+    for (int precision = 15; precision <= 17; precision++) {
+        n = snprintf(tmp, sizeof(tmp), "%.*g", precision, value);
+        OK_ASSERT(n > 0 && (size_t)n < sizeof(tmp));
+
+        if (strtod(tmp, nullptr) == value) break;
+    }
+
+    char point = *localeconv()->decimal_point;
+    for (int i = 0; i < n; i++) {
+        if (tmp[i] == point) tmp[i] = '.';
+    }
+
+    memcpy(buf, tmp, n);
+    return (size_t)n;
+#endif // OK_FLOAT_CHARCONV
 }
 
-void File::seek_start() const {
-    off_t seek_res = _lseek(fd, 0, SEEK_SET);
-    OK_ASSERT(seek_res != (off_t)-1);
+String to_string(Allocator* allocator, uint32_t value) {
+    String s = String::alloc(allocator, MAX_INT_CHARS);
+    s.append_uint(value);
+    return s;
 }
 
-off_t File::seek_end() const {
-    off_t seek_res = _lseek(fd, 0, SEEK_END);
-    OK_ASSERT(seek_res != (off_t)-1);
+String to_string(Allocator* allocator, int32_t value) {
+    String s = String::alloc(allocator, MAX_INT_CHARS);
+    s.append_int(value);
+    return s;
+}
 
-    return seek_res;
+String to_string(Allocator* allocator, uint64_t value) {
+    String s = String::alloc(allocator, MAX_INT_CHARS);
+    s.append_uint(value);
+    return s;
 }
 
-size_t File::size() const {
-    off_t res = seek_end();
-    seek_start();
-    return res;
+String to_string(Allocator* allocator, int64_t value) {
+    String s = String::alloc(allocator, MAX_INT_CHARS);
+    s.append_int(value);
+    return s;
 }
 
-static inline int64_t _read(int fd, void* buffer, size_t count) {
-#if OK_UNIX
-    return ::read(fd, buffer, count);
-#elif OK_WINDOWS
-    return ::_read(fd, buffer, (unsigned int)count);
-#endif // OK_UNIX
+String to_string(Allocator* allocator, double value) {
+    String s = String::alloc(allocator, MAX_DOUBLE_CHARS);
+    s.append_double(value);
+    return s;
 }
 
-Optional<File::ReadError> File::read(uint8_t* buf, size_t count) {
-    int64_t r = ok::_read(fd, buf, count);
+// Parses the digits of source[start..], leaving the value in `out` only when it fits in `limit`
+static bool _parse_digits(StringView source, size_t start, uint64_t limit, uint64_t* out) {
+    if (start >= source.count) return false;
 
-    if (r < 0) {
-        switch (errno) {
-        case EIO: return ReadError::IO_ERROR;
-        case EFAULT: OK_PANIC_FMT("The buffer (%p) is mapped outside the current process", buf);
-        default: OK_UNREACHABLE();
-        }
+    uint64_t result = 0;
+
+    for (size_t i = start; i < source.count; i++) {
+        char c = source.data[i];
+        if (!is_digit(c)) return false;
+
+        uint64_t digit = (uint64_t)(c - '0');
+        if (result > (limit - digit) / 10) return false;
+
+        result = result * 10 + digit;
     }
 
-    return {};
+    *out = result;
+    return true;
 }
 
-Optional<File::ReadError> File::read_full(Allocator* a, List<uint8_t>* out) {
-    size_t sz = size();
-    *out = List<uint8_t>::alloc(a, sz);
-    out->count = sz;
-    return read(out->items, sz);
+bool parse_uint64(StringView source, uint64_t* out) {
+    return _parse_digits(source, 0, UINT64_MAX, out);
 }
 
-// PROCEDURES IMPLEMENTATION
-String to_string(Allocator* allocator, uint32_t value) {
-    String s = String::alloc(allocator, 10);
+bool parse_int64(StringView source, int64_t* out) {
+    if (source.count == 0) return false;
 
-    uint32_t value_copy = value;
-    int idx = 0;
+    bool negative = source.data[0] == '-';
+    uint64_t limit = negative ? (uint64_t)INT64_MAX + 1 : (uint64_t)INT64_MAX;
 
-    while (value_copy /= 10) idx++;
+    uint64_t magnitude;
+    if (!_parse_digits(source, negative ? 1 : 0, limit, &magnitude)) return false;
 
-    size_t string_count = idx + 1;
+    *out = negative ? (int64_t)((uint64_t)0 - magnitude) : (int64_t)magnitude;
+    return true;
+}
 
-    do {
-        char digit = value % 10;
-        value /= 10;
-        s.data.items[idx--] = digit + '0';
-    } while (value != 0);
+static const double _EXACT_POWERS_OF_10[] = {
+    1e0,  1e1,  1e2,  1e3,  1e4,  1e5,  1e6,  1e7,  1e8,  1e9,  1e10, 1e11,
+    1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22,
+};
 
-    s.data.items[string_count] = String::NULL_CHAR;
-    s.data.count = string_count + 1;
+// Accepts [+-]digits[.digits][(e|E)[+-]digits], "inf" and "nan". When the significant digits fit
+// in 53 bits and the exponent is within the exactly representable powers of ten, the result is
+// computed with a single correctly rounded multiplication or division, otherwise strtod is used
+bool parse_double(StringView source, double* out) {
+    size_t i = 0;
+    bool negative = false;
 
-    return s;
-}
+    if (i < source.count && (source.data[i] == '-' || source.data[i] == '+')) {
+        negative = source.data[i] == '-';
+        i++;
+    }
 
-String to_string(Allocator* allocator, int32_t input_value) {
-    String s = String::alloc(allocator, 10);
+    StringView rest = source.view(i);
+    if (rest == "inf"_sv || rest == "nan"_sv) {
+        double value = rest == "inf"_sv ? HUGE_VAL : NAN;
+        *out = negative ? -value : value;
+        return true;
+    }
+
+    uint64_t mantissa = 0;
+    int significant_digits = 0;
+    int64_t exponent = 0;
+    bool truncated = false;
+    bool any_digits = false;
+
+    for (; i < source.count && is_digit(source.data[i]); i++) {
+        any_digits = true;
+
+        if (significant_digits < 19) {
+            mantissa = mantissa * 10 + (uint64_t)(source.data[i] - '0');
+            if (mantissa != 0) significant_digits++;
+        } else {
+            if (source.data[i] != '0') truncated = true;
+            exponent++;
+        }
+    }
+
+    if (i < source.count && source.data[i] == '.') {
+        i++;
 
-    uint32_t value = input_value;
-    int idx = 0;
+        for (; i < source.count && is_digit(source.data[i]); i++) {
+            any_digits = true;
 
-    if (input_value < 0) {
-        s.push('-');
-        value = (uint32_t)-input_value;
-        idx = 1;
+            if (significant_digits < 19) {
+                mantissa = mantissa * 10 + (uint64_t)(source.data[i] - '0');
+                if (mantissa != 0) significant_digits++;
+                exponent--;
+            } else if (source.data[i] != '0') {
+                truncated = true;
+            }
+        }
     }
 
-    uint32_t value_copy = value;
+    if (!any_digits) return false;
 
-    while (value_copy /= 10) idx++;
+    if (i < source.count && (source.data[i] == 'e' || source.data[i] == 'E')) {
+        i++;
 
-    size_t string_count = idx + 1;
+        bool negative_exponent = false;
+        if (i < source.count && (source.data[i] == '-' || source.data[i] == '+')) {
+            negative_exponent = source.data[i] == '-';
+            i++;
+        }
 
-    do {
-        char digit = value % 10;
-        value /= 10;
-        s.data.items[idx--] = digit + '0';
-    } while (value != 0);
+        if (i >= source.count || !is_digit(source.data[i])) return false;
 
-    s.data.items[string_count] = String::NULL_CHAR;
-    s.data.count = string_count + 1;
+        int64_t written_exponent = 0;
+        for (; i < source.count && is_digit(source.data[i]); i++) {
+            if (written_exponent < 100'000) written_exponent = written_exponent * 10 + (source.data[i] - '0');
+        }
 
-    return s;
-}
+        exponent += negative_exponent ? -written_exponent : written_exponent;
+    }
 
-String to_string(Allocator* allocator, uint64_t value) {
-    String s = String::alloc(allocator, 10);
+    if (i != source.count) return false;
+
+    if (!truncated && mantissa <= ((uint64_t)1 << 53) && exponent >= -22 && exponent <= 22) {
+        double value = (double)mantissa;
+        value = exponent < 0 ? value / _EXACT_POWERS_OF_10[-exponent] : value * _EXACT_POWERS_OF_10[exponent];
 
-    uint64_t value_copy = value;
-    int idx = 0;
+        *out = negative ? -value : value;
+        return true;
+    }
+
+#if OK_FLOAT_CHARCONV
+    // the input was validated above, so only the range can go wrong. from_chars takes no '+'
+    size_t start = source.count > 0 && source.data[0] == '+' ? 1 : 0;
+    double value = 0.0;
+    auto result = std::from_chars(source.data + start, source.data + source.count, value);
+
+    if (result.ec == std::errc::result_out_of_range) {
+        // values too small for a double round to zero like strtod does, too big ones are rejected
+        if (exponent + significant_digits > 0) return false;
+        value = negative ? -0.0 : 0.0;
+    }
+#else
+    // strtod needs a terminated copy that uses the locale's decimal point
+    char small[128];
+    char* cstr = small;
+    bool heap = source.count >= sizeof(small);
 
-    while (value_copy /= 10) idx++;
+    if (heap) cstr = static_allocator->alloc<char>(source.count + 1);
 
-    size_t string_count = idx + 1;
+    char point = *localeconv()->decimal_point;
+    for (size_t j = 0; j < source.count; j++) cstr[j] = source.data[j] == '.' ? point : source.data[j];
+    cstr[source.count] = '\0';
 
-    do {
-        char digit = value % 10;
-        value /= 10;
-        s.data.items[idx--] = digit + '0';
-    } while (value != 0);
+    errno = 0;
+    double value = strtod(cstr, nullptr);
+    bool overflow = errno == ERANGE && std::isinf(value);
 
-    s.data.items[string_count] = String::NULL_CHAR;
-    s.data.count = string_count + 1;
+    if (heap) static_allocator->dealloc(cstr, source.count + 1);
+    if (overflow) return false;
+#endif // OK_FLOAT_CHARCONV
 
-    return s;
+    *out = value;
+    return true;
+}
+
+static uint64_t _monotonic_ns() {
+#if OK_WINDOWS
+    return (uint64_t)::GetTickCount64() * 1'000'000;
+#else
+    timespec ts;
+    ::clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1'000'000'000 + (uint64_t)ts.tv_nsec;
+#endif // OK_WINDOWS
 }
 
-String to_string(Allocator* allocator, int64_t input_value) {
-    String s = String::alloc(allocator, 10);
+static constexpr int _STDOUT_FD = 1;
+static constexpr int _STDERR_FD = 2;
 
-    uint64_t value = input_value;
-    int idx = 0;
+static void _write_all(int fd, const char* data, size_t count) {
+    while (count > 0) {
+        int64_t n = ok::_write(fd, data, count);
 
-    if (input_value < 0) {
-        s.push('-');
-        value = -input_value;
-        idx = 1;
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            // there is nowhere left to report the error to
+            return;
+        }
+
+        data += n;
+        count -= (size_t)n;
     }
+}
 
-    uint64_t value_copy = value;
+uint64_t output_flush_interval_ns = OUTPUT_FLUSH_INTERVAL_NS;
 
-    while (value_copy /= 10) idx++;
+struct _OutputBuffer {
+    // thread_locals go before statics, whose destructors may still print
+    ~_OutputBuffer() {
+        flush();
+        if (data != nullptr) OK_DEALLOC_PAGE(data, OUTPUT_BUFFER_SIZE);
 
-    size_t string_count = idx + 1;
+        data = nullptr;
+        count = 0;
+        destroyed = true;
+    }
 
-    do {
-        char digit = value % 10;
-        value /= 10;
-        s.data.items[idx--] = digit + '0';
-    } while (value != 0);
+    void flush() {
+        if (count > 0) _write_all(_STDOUT_FD, data, count);
 
-    s.data.items[string_count] = String::NULL_CHAR;
-    s.data.count = string_count + 1;
+        count = 0;
+        last_flush = _monotonic_ns();
+    }
 
-    return s;
-}
+    void append_line(StringView sv) {
+        if (count + sv.count + 1 > OUTPUT_BUFFER_SIZE) flush();
 
-bool parse_int64(StringView source, int64_t* out) {
-    if (source.count == 0) return false;
+        if (destroyed || sv.count + 1 > OUTPUT_BUFFER_SIZE) {
+            _write_all(_STDOUT_FD, sv.data, sv.count);
+            _write_all(_STDOUT_FD, "\n", 1);
+            return;
+        }
 
-    int64_t result = 0;
-    size_t coef = 1;
+        if (data == nullptr) data = (char*)OK_ALLOC_PAGE(OUTPUT_BUFFER_SIZE);
 
-    for (intptr_t i = source.count - 1; i > 0; --i) {
-        auto c = source[i];
-        if (!is_digit(c)) return false;
+        memcpy(data + count, sv.data, sv.count);
+        data[count + sv.count] = '\n';
+        count += sv.count + 1;
 
-        uint8_t digit = c - '0';
-        result += digit * coef;
-        coef *= 10;
+        if (_monotonic_ns() - last_flush >= output_flush_interval_ns) flush();
     }
 
-    if (is_digit(source[0])) result += (source[0] - '0') * coef;
-    else if (source[0] == '-') result = -result;
-    else return false;
+    char* data;
+    size_t count;
+    uint64_t last_flush;
+    bool destroyed;
+};
 
-    *out = result;
+thread_local _OutputBuffer _stdout_buffer{};
 
-    return true;
+void flush_output() {
+    _stdout_buffer.flush();
 }
 
 void println(const char* msg) {
-    ::printf("%s\n", msg);
+    _stdout_buffer.append_line(StringView{msg});
 }
 
 void println(StringView sv) {
-    ::printf(OK_SV_FMT "\n", OK_SV_ARG(sv));
+    _stdout_buffer.append_line(sv);
 }
 
-void println(String string) {
-    ::printf("%s\n", string.cstr());
+void println(const String& string) {
+    _stdout_buffer.append_line(string.view());
 }
 
-void eprintln(const char* msg) {
-    ::fprintf(stderr, "%s\n", msg);
+void eprintln(StringView sv) {
+    _stdout_buffer.flush();
+
+    // short lines get their newline attached so that they go out in one write
+    char line[1024];
+
+    if (sv.count < sizeof(line)) {
+        memcpy(line, sv.data, sv.count);
+        line[sv.count] = '\n';
+        _write_all(_STDERR_FD, line, sv.count + 1);
+        return;
+    }
+
+    _write_all(_STDERR_FD, sv.data, sv.count);
+    _write_all(_STDERR_FD, "\n", 1);
 }
 
-void eprintln(StringView sv) {
-    ::fprintf(stderr, OK_SV_FMT "\n", OK_SV_ARG(sv));
+void eprintln(const char* msg) {
+    eprintln(StringView{msg});
 }
 
-void eprintln(String string) {
-    ::fprintf(stderr, "%s\n", string.cstr());
+void eprintln(const String& string) {
+    eprintln(string.view());
 }
 
 bool is_whitespace(char c) {
@@ -1510,6 +7713,80 @@ bool is_alpha(char c) {
 
 // HASHES IMPLEMENTATION
 namespace hash {
+uint64_t default_seed = 0;
+
+static const uint64_t _wyp[4] = {
+    0x2d358dccaa6c78a5ull, 0x8bb84b93962eacc9ull, 0x4b33a62ed433d4a3ull, 0x4d5a2da51de1aa47ull,
+};
+
+static inline uint64_t _wyr8(const uint8_t* p) {
+    uint64_t v;
+    memcpy(&v, p, 8);
+    return v;
+}
+
+static inline uint64_t _wyr4(const uint8_t* p) {
+    uint32_t v;
+    memcpy(&v, p, 4);
+    return v;
+}
+
+static inline uint64_t _wyr3(const uint8_t* p, size_t k) {
+    return ((uint64_t)p[0] << 16) | ((uint64_t)p[k >> 1] << 8) | p[k - 1];
+}
+
+uint64_t wyhash(StringView sv, uint64_t seed) {
+    const uint8_t* p = (const uint8_t*)sv.data;
+    size_t len = sv.count;
+
+    seed ^= mum_mix(seed ^ _wyp[0], _wyp[1]);
+
+    uint64_t a, b;
+
+    if (len <= 16) {
+        if (len >= 4) {
+            a = (_wyr4(p) << 32) | _wyr4(p + ((len >> 3) << 2));
+            b = (_wyr4(p + len - 4) << 32) | _wyr4(p + len - 4 - ((len >> 3) << 2));
+        } else if (len > 0) {
+            a = _wyr3(p, len);
+            b = 0;
+        } else {
+            a = b = 0;
+        }
+    } else {
+        size_t i = len;
+
+        if (i >= 48) {
+            uint64_t see1 = seed, see2 = seed;
+
+            do {
+                seed = mum_mix(_wyr8(p) ^ _wyp[1], _wyr8(p + 8) ^ seed);
+                see1 = mum_mix(_wyr8(p + 16) ^ _wyp[2], _wyr8(p + 24) ^ see1);
+                see2 = mum_mix(_wyr8(p + 32) ^ _wyp[3], _wyr8(p + 40) ^ see2);
+                p += 48;
+                i -= 48;
+            } while (i >= 48);
+
+            seed ^= see1 ^ see2;
+        }
+
+        while (i > 16) {
+            seed = mum_mix(_wyr8(p) ^ _wyp[1], _wyr8(p + 8) ^ seed);
+            i -= 16;
+            p += 16;
+        }
+
+        a = _wyr8(p + i - 16);
+        b = _wyr8(p + i - 8);
+    }
+
+    a ^= _wyp[1];
+    b ^= seed;
+    mum(&a, &b);
+
+    return mum_mix(a ^ _wyp[0] ^ len, b ^ _wyp[1]);
+}
+
 uint64_t fnv1(StringView sv) {
     constexpr const uint64_t fnv_offset_basis = 0xCBF29CE484222325;
     constexpr const uint64_t fnv_prime = 0x100000001B3;
@@ -0,0 +1,92 @@
+#define OK_ALLOCATOR_STATS 1
+#define OK_ALLOCATOR_TRACING 1
+#define OK_IMPLEMENTATION
+#include "../ok.hpp"
+
+using namespace ok;
+
+int main() {
+    ArenaAllocator arena{};
+
+    int* ints = arena.alloc<int>(3);
+    OK_ASSERT(arena.stats.bytes_allocated == 3 * sizeof(int));
+    OK_ASSERT(arena.stats.padding_bytes == align_to(3 * sizeof(int), sizeof(void*)) - 3 * sizeof(int));
+    OK_ASSERT(arena.stats.live_count == 1);
+    OK_ASSERT(arena.stats.region_count == 1 && arena.region_count() == 1);
+    OK_ASSERT(arena.stats.reserved_bytes == ArenaAllocator::DEFAULT_REGION_SIZE);
+
+    ints = arena.resize(ints, 3, 8);
+    OK_ASSERT(arena.stats.live_bytes() == 8 * sizeof(int));
+    OK_ASSERT(arena.stats.live_count == 1);
+    OK_ASSERT(arena.used() == 8 * sizeof(int));
+
+    arena.dealloc(ints, 8);
+    OK_ASSERT(arena.stats.live_bytes() == 0 && arena.stats.live_count == 0);
+    OK_ASSERT(arena.stats.peak_bytes == 8 * sizeof(int));
+    OK_ASSERT(arena.used() == 0);
+
+    arena.alloc<uint8_t>(ArenaAllocator::DEFAULT_REGION_SIZE);
+    arena.alloc<uint8_t>(100);
+    OK_ASSERT(arena.stats.region_count == 2 && arena.region_count() == 2);
+    OK_ASSERT(arena.stats.fragmentation() > 0.0 && arena.stats.fragmentation() < 1.0);
+
+    arena.reset();
+    OK_ASSERT(arena.stats.live_count == 0 && arena.stats.live_bytes() == 0);
+    OK_ASSERT(arena.stats.allocation_count == 3);
+
+    arena.free();
+    OK_ASSERT(arena.stats.region_count == 0 && arena.stats.reserved_bytes == 0);
+
+    PoolAllocator pool{};
+
+    void* block = pool.raw_alloc(20);
+    OK_ASSERT(pool.stats.padding_bytes == PoolAllocator::block_size(1) - 20);
+    OK_ASSERT(pool.stats.region_count == 1);
+
+    void* large = pool.raw_alloc(PoolAllocator::MAX_BLOCK_SIZE + 1);
+    OK_ASSERT(pool.stats.region_count == 2);
+    pool.raw_dealloc(large, PoolAllocator::MAX_BLOCK_SIZE + 1);
+    OK_ASSERT(pool.stats.region_count == 1);
+
+    pool.raw_dealloc(block, 20);
+    OK_ASSERT(pool.stats.live_count == 0 && pool.stats.live_bytes() == 0);
+
+    pool.free();
+    OK_ASSERT(pool.stats.region_count == 0 && pool.stats.reserved_bytes == 0);
+
+    FixedBufferAllocator fixed{};
+    fixed.alloc<int>(2);
+    OK_ASSERT(fixed.stats.region_count == 1 && fixed.stats.live_bytes() == 2 * sizeof(int));
+    fixed.free();
+    OK_ASSERT(fixed.stats.region_count == 0);
+
+    TracingAllocator tracer{};
+    TracingAllocator::init(&tracer, &arena, 4);
+    OK_ASSERT(tracer.event_capacity == 4);
+
+    int* traced = OK_TRACE_SITE(&tracer)->alloc<int>(4);
+    uint32_t traced_line = __LINE__ - 1;
+
+    OK_ASSERT(tracer.retained() == 1);
+    OK_ASSERT(tracer.event(0).kind == TracingAllocator::EventKind::ALLOC);
+    OK_ASSERT(tracer.event(0).ptr == traced && tracer.event(0).size == 4 * sizeof(int));
+    OK_ASSERT(strcmp(tracer.event(0).file, __FILE__) == 0 && tracer.event(0).line == traced_line);
+
+    traced = tracer.resize(traced, 4, 16);
+    OK_ASSERT(tracer.event(1).kind == TracingAllocator::EventKind::RESIZE);
+    OK_ASSERT(tracer.event(1).old_size == 4 * sizeof(int) && tracer.event(1).file == nullptr);
+
+    tracer.dealloc(traced, 16);
+    OK_ASSERT(tracer.stats.live_bytes() == 0 && tracer.stats.peak_bytes == 16 * sizeof(int));
+
+    // the oldest events get overwritten
+    for (int i = 0; i < 3; i++) tracer.alloc<int>(i + 1);
+    OK_ASSERT(tracer.event_count == 6 && tracer.retained() == 4);
+    OK_ASSERT(tracer.event(0).kind == TracingAllocator::EventKind::DEALLOC);
+    OK_ASSERT(tracer.event(3).size == 3 * sizeof(int));
+
+    tracer.free();
+    arena.free();
+
+    return 0;
+}
@@ -23,5 +23,45 @@ int main() {
     OK_ASSERT(one_int == one_other_int);
     OK_ASSERT(*one_other_int == funny_int);
 
+    size_t region_count = 0;
+    for (size_t i = 0; i < 100'000; i++) arena.alloc<uint64_t>(16);
+    for (auto* r = arena.head; r != nullptr; r = r->next) region_count++;
+
+    OK_ASSERT(region_count < 16);
+
+    arena.reset();
+
+    List<int> ints = List<int>::alloc(&arena, 4);
+    int* ints_items = ints.items;
+
+    for (int i = 0; i < 1000; i++) ints.push(i);
+
+    OK_ASSERT(ints.items == ints_items);
+    OK_ASSERT(ints[999] == 999);
+
+    arena.reset();
+
+    int* long_lived = arena.alloc<int>(1);
+    *long_lived = funny_int;
+
+    for (int i = 0; i < 100; i++) {
+        Allocator::Scope scope{&arena};
+
+        uint8_t* scratch = arena.alloc<uint8_t>(OK_PAGE_SIZE * 8);
+        memset(scratch, 0xAA, OK_PAGE_SIZE * 8);
+    }
+
+    OK_ASSERT(*long_lived == funny_int);
+    OK_ASSERT(arena.alloc<int>(1) == long_lived + 2);
+
+    auto marker = arena.mark();
+    int* before = arena.alloc<int>(1);
+    arena.restore(marker);
+    OK_ASSERT(arena.alloc<int>(1) == before);
+
+    arena.free();
+
+    OK_ASSERT(arena.head == nullptr);
+
     return 0;
 }
@@ -0,0 +1,88 @@
+#define OK_IMPLEMENTATION
+#include "../ok.hpp"
+
+using namespace ok;
+
+int main() {
+    AsyncIo io;
+    OK_ASSERT(!AsyncIo::init(&io, static_allocator, 8).has_value());
+
+    File file;
+    OK_ASSERT(!File::open(&file, __FILE__).has_value());
+
+    const char* prefix = "#define OK_IMPLEMENTATION";
+    uint8_t chunks[4][8];
+
+    for (uint64_t i = 0; i < 4; i++) {
+        OK_ASSERT(io.queue_read(file, chunks[i], 4, i * 4, i));
+    }
+
+    OK_ASSERT(io.pending() == 4);
+    OK_ASSERT(!io.submit().has_value());
+
+    AsyncIo::Completion completions[8];
+    size_t done = 0;
+
+    while (done < 4) {
+        size_t n;
+        OK_ASSERT(!io.wait(completions + done, 8 - done, 1, &n).has_value());
+        done += n;
+    }
+
+    OK_ASSERT(io.pending() == 0);
+
+    for (size_t i = 0; i < done; i++) {
+        uint64_t idx = completions[i].user_data;
+        OK_ASSERT(completions[i].result == 4);
+        OK_ASSERT(memcmp(chunks[idx], prefix + idx * 4, 4) == 0);
+    }
+
+    const char* tmp_path = "async-io.test.tmp";
+    File out;
+    OK_ASSERT(!File::create(&out, tmp_path).has_value());
+
+    for (uint64_t i = 0; i < 8; i++) {
+        OK_ASSERT(io.queue_write(out, (const uint8_t*)"abcdefgh" + i, 1, i, i));
+    }
+
+    OK_ASSERT(!io.queue_write(out, (const uint8_t*)"x", 1, 8, 8));
+    OK_ASSERT(!io.submit().has_value());
+
+    size_t n;
+    OK_ASSERT(!io.wait(completions, 8, 8, &n).has_value());
+    OK_ASSERT(n == 8);
+
+    uint8_t written[8];
+    OK_ASSERT(!out.read_at(written, 8, 0).has_value());
+    OK_ASSERT(memcmp(written, "abcdefgh", 8) == 0);
+
+#if OK_IO_URING
+    if (io.backend == AsyncIo::Backend::IO_URING) {
+        // a failed submit keeps the published entries for the next one instead of writing them twice
+        for (uint64_t i = 0; i < 4; i++) OK_ASSERT(io.queue_read(file, chunks[i], 4, i * 4, i));
+
+        int ring_fd = io.ring.fd;
+        io.ring.fd = -1;
+        OK_ASSERT(io.submit().has_value());
+        OK_ASSERT(io.queued_count == 0 && io.pending() == 4);
+
+        io.ring.fd = ring_fd;
+        OK_ASSERT(!io.submit().has_value());
+        OK_ASSERT(!io.wait(completions, 8, 4, &n).has_value());
+        OK_ASSERT(n == 4 && io.pending() == 0);
+        OK_ASSERT(io.poll(completions, 8) == 0);
+
+        // a duplicate left in the ring would go out ahead of the next request
+        OK_ASSERT(io.queue_read(file, chunks[0], 4, 0, 99));
+        OK_ASSERT(!io.submit().has_value());
+        OK_ASSERT(!io.wait(completions, 8, 1, &n).has_value());
+        OK_ASSERT(n == 1 && completions[0].user_data == 99);
+    }
+#endif // OK_IO_URING
+
+    out.close();
+    remove(tmp_path);
+    io.deinit();
+
+    return 0;
+}
@@ -0,0 +1,56 @@
+#define OK_IMPLEMENTATION
+#include "../ok.hpp"
+
+using namespace ok;
+
+int main() {
+    const char* path = "buffered-io.test.tmp";
+    const size_t line_count = 10'000;
+
+    File file;
+    OK_ASSERT(!File::create(&file, path).has_value());
+
+    auto writer = BufferedWriter::alloc(static_allocator, &file, 64);
+
+    for (size_t i = 0; i < line_count; i++) {
+        Allocator::Scope scope{temp_allocator};
+
+        String line = String::format(temp_allocator, "line %zu\n", i);
+        OK_ASSERT(!writer.write(line.view()).has_value());
+    }
+
+    char long_line[1000];
+    memset(long_line, 'x', sizeof(long_line));
+    StringView long_line_view{long_line, sizeof(long_line)};
+
+    OK_ASSERT(!writer.write(long_line_view).has_value());
+    OK_ASSERT(!writer.write("\r\nlast"_sv).has_value());
+    OK_ASSERT(!writer.flush().has_value());
+
+    file.seek_start();
+
+    auto reader = BufferedReader::alloc(static_allocator, &file, 16);
+    Optional<StringView> line;
+
+    for (size_t i = 0; i < line_count; i++) {
+        Allocator::Scope scope{temp_allocator};
+
+        OK_ASSERT(!reader.read_line(&line).has_value());
+        OK_ASSERT(line.has_value());
+        OK_ASSERT(line.get() == String::format(temp_allocator, "line %zu", i));
+    }
+
+    OK_ASSERT(!reader.read_line(&line).has_value());
+    OK_ASSERT(line.get() == long_line_view);
+
+    OK_ASSERT(!reader.read_line(&line).has_value());
+    OK_ASSERT(line.get() == "last"_sv);
+
+    OK_ASSERT(!reader.read_line(&line).has_value());
+    OK_ASSERT(!line.has_value());
+
+    file.close();
+    remove(path);
+
+    return 0;
+}
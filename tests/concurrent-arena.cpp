@@ -0,0 +1,71 @@
+#define OK_IMPLEMENTATION
+#include "../ok.hpp"
+
+#include <thread>
+
+using namespace ok;
+
+static constexpr size_t THREAD_COUNT = 8;
+static constexpr size_t ALLOCS_PER_THREAD = 10'000;
+
+static void fill(Allocator* a, size_t thread_idx, Allocator** temp_out, bool* ok_out) {
+    size_t** ptrs = temp_allocator->alloc<size_t*>(ALLOCS_PER_THREAD);
+    *temp_out = temp_allocator;
+
+    for (size_t i = 0; i < ALLOCS_PER_THREAD; i++) {
+        ptrs[i] = a->alloc<size_t>(1 + i % 8);
+        *ptrs[i] = thread_idx * ALLOCS_PER_THREAD + i;
+    }
+
+    bool ok = true;
+    for (size_t i = 0; i < ALLOCS_PER_THREAD; i++) {
+        if (*ptrs[i] != thread_idx * ALLOCS_PER_THREAD + i) ok = false;
+    }
+
+    *ok_out = ok;
+}
+
+int main() {
+    ConcurrentArenaAllocator arena{};
+
+    int* one_int = arena.alloc<int>();
+    *one_int = 123;
+
+    arena.reset();
+    OK_ASSERT(arena.alloc<int>() == one_int);
+
+    int* grown = arena.resize<int>(one_int, 1, 1024);
+    OK_ASSERT(grown == one_int);
+
+    Allocator* temps[THREAD_COUNT];
+    bool oks[THREAD_COUNT];
+
+    Allocator* allocators[] = {&arena, static_allocator};
+
+    for (Allocator* a : allocators) {
+        std::thread threads[THREAD_COUNT];
+
+        for (size_t i = 0; i < THREAD_COUNT; i++) {
+            threads[i] = std::thread{fill, a, i, &temps[i], &oks[i]};
+        }
+
+        for (auto& t : threads) t.join();
+
+        for (size_t i = 0; i < THREAD_COUNT; i++) {
+            OK_ASSERT(oks[i]);
+            OK_ASSERT(temps[i] != temp_allocator);
+
+            for (size_t j = i + 1; j < THREAD_COUNT; j++) OK_ASSERT(temps[i] != temps[j]);
+        }
+    }
+
+    auto marker = arena.mark();
+    int* before = arena.alloc<int>(16);
+    arena.restore(marker);
+    OK_ASSERT(arena.alloc<int>(16) == before);
+
+    arena.free();
+    OK_ASSERT(arena.head.load() == nullptr);
+
+    return 0;
+}
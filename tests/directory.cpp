@@ -0,0 +1,130 @@
+#define OK_IMPLEMENTATION
+#include "../ok.hpp"
+
+#include <atomic>
+
+using namespace ok;
+
+static const char* ROOT = "directory.test.tmp";
+
+static void write_file(const char* path, StringView contents) {
+    File file;
+    OK_ASSERT(!File::create(&file, path).has_value());
+    OK_ASSERT(!file.write(contents).has_value());
+    file.close();
+}
+
+int main() {
+    const char* dirs[] = {
+        "directory.test.tmp",
+        "directory.test.tmp/a",
+        "directory.test.tmp/a/b",
+        "directory.test.tmp/c",
+    };
+    const char* files[] = {
+        "directory.test.tmp/one.txt",
+        "directory.test.tmp/a/two.txt",
+        "directory.test.tmp/a/b/three.txt",
+        "directory.test.tmp/c/four.txt",
+    };
+
+    for (const char* dir : dirs) ::mkdir(dir, 0755);
+    for (const char* file : files) write_file(file, "hello"_sv);
+
+    {
+        DirectoryIterator it;
+        OK_ASSERT(!DirectoryIterator::open(&it, temp_allocator, ROOT).has_value());
+
+        size_t entries = 0;
+        bool saw_file = false;
+        bool saw_dir = false;
+
+        for (;;) {
+            Optional<DirectoryIterator::Entry> listed;
+            OK_ASSERT(!it.next(&listed).has_value());
+            if (!listed.has_value()) break;
+
+            auto& entry = listed.get();
+            entries++;
+
+            DirectoryIterator::Info info;
+            OK_ASSERT(!it.stat(entry, &info).has_value());
+            OK_ASSERT(entry.type == DirectoryIterator::EntryType::UNKNOWN || entry.type == info.type);
+
+            if (entry.name == "one.txt"_sv) {
+                saw_file = true;
+                OK_ASSERT(info.type == DirectoryIterator::EntryType::FILE && info.size == 5);
+            }
+
+            if (entry.name == "a"_sv) {
+                saw_dir = true;
+                OK_ASSERT(info.type == DirectoryIterator::EntryType::DIRECTORY);
+            }
+        }
+
+        OK_ASSERT(entries == 3 && saw_file && saw_dir);
+        it.close();
+    }
+
+    {
+        DirectoryIterator it;
+        auto err = DirectoryIterator::open(&it, temp_allocator, "directory.test.tmp/missing");
+        OK_ASSERT(err.has_value() && err.get() == DirectoryIterator::OpenError::NOT_FOUND);
+
+        err = DirectoryIterator::open(&it, temp_allocator, files[0]);
+        OK_ASSERT(err.has_value() && err.get() == DirectoryIterator::OpenError::NOT_A_DIRECTORY);
+
+#if OK_UNIX
+        // errors without a variant of their own are reported rather than aborting the walk
+        OK_ASSERT(_to_directory_open_error(EIO, ROOT) == DirectoryIterator::OpenError::IO_ERROR);
+        OK_ASSERT(_to_directory_open_error(EOVERFLOW, ROOT) == DirectoryIterator::OpenError::IO_ERROR);
+        OK_ASSERT(_to_directory_open_error(EPERM, ROOT) == DirectoryIterator::OpenError::ACCESS_DENIED);
+#endif // OK_UNIX
+    }
+
+    for (size_t threads = 1; threads <= 4; threads++) {
+        std::atomic<size_t> file_count{0};
+        std::atomic<size_t> dir_count{0};
+        std::atomic<size_t> deepest{0};
+
+        auto err = DirectoryWalker::walk(ROOT, [&](const DirectoryWalker::Entry& entry) {
+            if (entry.type == DirectoryIterator::EntryType::DIRECTORY) dir_count++;
+            if (entry.type == DirectoryIterator::EntryType::FILE) {
+                file_count++;
+                OK_ASSERT(entry.path.ends_with(entry.name));
+            }
+
+            if (entry.name == "three.txt"_sv) {
+                OK_ASSERT(entry.path == "directory.test.tmp/a/b/three.txt"_sv);
+                deepest = entry.depth;
+            }
+
+            return true;
+        }, threads);
+
+        OK_ASSERT(!err.has_value());
+        OK_ASSERT(file_count == 4 && dir_count == 3 && deepest == 2);
+    }
+
+    {
+        // skipping a directory leaves out everything below it
+        std::atomic<size_t> visited{0};
+
+        DirectoryWalker::walk(ROOT, [&](const DirectoryWalker::Entry& entry) {
+            visited++;
+            return !(entry.name == "a"_sv);
+        }, 2);
+
+        OK_ASSERT(visited == 4);
+    }
+
+    auto err = DirectoryWalker::walk("directory.test.tmp/missing", [](const DirectoryWalker::Entry&) {
+        return true;
+    });
+    OK_ASSERT(err.has_value());
+
+    for (const char* file : files) remove(file);
+    for (size_t i = sizeof(dirs) / sizeof(dirs[0]); i > 0; i--) ::rmdir(dirs[i - 1]);
+
+    return 0;
+}
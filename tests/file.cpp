@@ -18,5 +18,65 @@ int main() {
 
     OK_ASSERT(s.starts_with("#define OK_IMPLEMENTATION"_sv));
 
+    File::Mapping mapping;
+    auto map_err = file.map(&mapping, File::AccessPattern::SEQUENTIAL);
+    OK_ASSERT(!map_err.has_value());
+    OK_ASSERT(mapping.size == buffer.count);
+    OK_ASSERT(mapping.view() == s.view());
+
+    mapping.unmap();
+    OK_ASSERT(mapping.data == nullptr);
+
+    const char* prefix = "#define OK_IMPLEMENTATION";
+    size_t prefix_len = strlen(prefix);
+
+    uint8_t at_buf[16];
+    size_t at_read;
+    OK_ASSERT(!file.read_at(at_buf, 8, 8, &at_read).has_value());
+    OK_ASSERT(at_read == 8);
+    OK_ASSERT(memcmp(at_buf, prefix + 8, 8) == 0);
+
+    auto first = List<uint8_t>::alloc(temp_allocator, 3);
+    auto second = List<uint8_t>::alloc(temp_allocator, prefix_len - 3);
+    List<uint8_t>* lists[] = {&first, &second};
+
+    size_t vec_read;
+    OK_ASSERT(!file.readv_at(Slice<List<uint8_t>*>{lists, 2}, 0, &vec_read).has_value());
+    OK_ASSERT(vec_read == prefix_len);
+    OK_ASSERT(memcmp(first.items, prefix, 3) == 0);
+    OK_ASSERT(memcmp(second.items, prefix + 3, prefix_len - 3) == 0);
+
+    const char* tmp_path = "file.test.tmp";
+    File out;
+    OK_ASSERT(!File::create(&out, tmp_path).has_value());
+
+    Slice<uint8_t> parts[] = {
+        Slice<uint8_t>{(const uint8_t*)"hello", 5},
+        Slice<uint8_t>{(const uint8_t*)", ", 2},
+        Slice<uint8_t>{(const uint8_t*)"world", 5},
+    };
+
+    OK_ASSERT(!out.writev(Slice<Slice<uint8_t>>{parts, 3}).has_value());
+    OK_ASSERT(!out.write_at((const uint8_t*)"W", 1, 7).has_value());
+    OK_ASSERT(out.size() == 12);
+
+    uint8_t out_buf[12];
+    OK_ASSERT(!out.read_at(out_buf, 12, 0).has_value());
+    OK_ASSERT(memcmp(out_buf, "hello, World", 12) == 0);
+
+    // read_full returns the whole file no matter where the offset is
+    out.seek_start();
+    uint8_t partial[5];
+    OK_ASSERT(!out.read(partial, 5).has_value());
+
+    for (int i = 0; i < 2; i++) {
+        List<uint8_t> full;
+        OK_ASSERT(!out.read_full(temp_allocator, &full).has_value());
+        OK_ASSERT(full.count == 12 && memcmp(full.items, "hello, World", 12) == 0);
+    }
+
+    out.close();
+    remove(tmp_path);
+
     return 0;
 }
@@ -18,6 +18,14 @@ int main() {
     OK_ASSERT(strcmp(hello_string.cstr(), hello) == 0);
     OK_ASSERT(strcmp(not_hello_string.cstr(), not_hello) == 0);
 
+    // short strings are stored in place
+    OK_ASSERT(a.buffer == nullptr);
+
+    const char* long_hello = "hello, this string does not fit in place";
+    String long_string = String::alloc(&a, long_hello);
+    OK_ASSERT(a.buffer != nullptr);
+    OK_ASSERT(strcmp(long_string.cstr(), long_hello) == 0);
+
     String* very_big_allocation = a.alloc<String>(1'000'000);
     OK_ASSERT(very_big_allocation == nullptr);
 
@@ -33,5 +41,19 @@ int main() {
     OK_ASSERT(smol_int != nullptr);
     OK_ASSERT(a.buffer_off == sizeof(void*));
 
+    {
+        Allocator::Scope scope{&a};
+        a.alloc<int>(64);
+        OK_ASSERT(a.buffer_off == sizeof(void*) + 64 * sizeof(int));
+    }
+
+    OK_ASSERT(a.buffer_off == sizeof(void*));
+    OK_ASSERT(a.wrap_count == 1);
+
+    a.on_full = FixedBufferAllocator::FullPolicy::FAIL;
+    OK_ASSERT(a.alloc<uint8_t>(bytes_count) == nullptr);
+    OK_ASSERT(a.buffer_off == sizeof(void*));
+    OK_ASSERT(a.wrap_count == 1);
+
     return 0;
 }
@@ -0,0 +1,59 @@
+#define OK_IMPLEMENTATION
+#include "../ok.hpp"
+
+using namespace ok;
+
+struct Point {
+    int x;
+    int y;
+};
+
+template <>
+struct ok::Formatter<Point> {
+    static void format(FormatSink* sink, const Point& p) {
+        format_to(sink, "({}, {})", p.x, p.y);
+    }
+};
+
+int main() {
+    Allocator* a = temp_allocator;
+
+    OK_ASSERT(format(a, "no placeholders") == "no placeholders"_sv);
+    OK_ASSERT(format(a, "{} + {} = {}", 1, 2u, (int64_t)3) == "1 + 2 = 3"_sv);
+    OK_ASSERT(format(a, "{}{}", -9223372036854775807LL - 1, UINT64_MAX) == "-922337203685477580818446744073709551615"_sv);
+    OK_ASSERT(format(a, "{} {} {}", 0.5, true, 'c') == "0.5 true c"_sv);
+    OK_ASSERT(format(a, "{{{}}}", 7) == "{7}"_sv);
+    OK_ASSERT(format(a, "}}{{") == "}{"_sv);
+
+    String name = String::alloc(a, "world");
+    const char* cstr = "cstr";
+    OK_ASSERT(format(a, "hello {}, {} and {} and {}", name, "literal", "view"_sv, cstr)
+              == "hello world, literal and view and cstr"_sv);
+
+    OK_ASSERT(format(a, "{}", (const void*)nullptr) == "0x0"_sv);
+    OK_ASSERT(format(a, "at {}", Point{1, -2}) == "at (1, -2)"_sv);
+
+    String out = String::alloc(a);
+    for (int i = 0; i < 100; i++) format_to(&out, "{},", i);
+    OK_ASSERT(out.count() == 10 * 2 + 90 * 3);
+    OK_ASSERT(out.view().ends_with("98,99,"_sv));
+
+    const char* path = "format.test.tmp";
+    File file;
+    OK_ASSERT(!File::create(&file, path).has_value());
+
+    BufferedWriter writer = BufferedWriter::alloc(static_allocator, &file, 16);
+    OK_ASSERT(!format_to(&writer, "{} is {} years old\n", "the header"_sv, 3).has_value());
+    OK_ASSERT(!writer.flush().has_value());
+
+    char contents[64];
+    size_t n;
+    OK_ASSERT(!file.read_at((uint8_t*)contents, sizeof(contents), 0, &n).has_value());
+    OK_ASSERT(StringView(contents, n) == "the header is 3 years old\n"_sv);
+
+    writer.free();
+    file.close();
+    remove(path);
+
+    return 0;
+}
@@ -8,5 +8,28 @@ int main() {
     OK_ASSERT(hash::fnv1("123"_sv) == 0xD97FFA186C3A60BB);
     OK_ASSERT(hash::fnv1("Ok!"_sv) == 0xD840C3186B2B5F00);
 
+    const char* text = "The quick brown fox jumps over the lazy dog, then does it again and again.";
+    size_t text_len = strlen(text);
+
+    auto seen = Set<size_t>::alloc(static_allocator);
+
+    for (size_t len = 0; len <= text_len; len++) {
+        StringView sv{text, len};
+        uint64_t h = hash::wyhash(sv, 0);
+
+        OK_ASSERT(h == hash::wyhash(StringView{text, len}, 0));
+        OK_ASSERT(h != hash::wyhash(sv, 1));
+        OK_ASSERT(!seen.has(h));
+
+        seen.put(h);
+    }
+
+    OK_ASSERT(Hash<StringView>::hash("abc"_sv) == Hash<String>::hash(String::alloc(temp_allocator, "abc")));
+
+    // sequential integers should not share the low bits used as table tags
+    size_t tag_counts[128] = {};
+    for (size_t i = 0; i < 128 * 64; i++) tag_counts[Hash<size_t>::hash(i) & 0x7F]++;
+    for (size_t i = 0; i < 128; i++) OK_ASSERT(tag_counts[i] > 16 && tag_counts[i] < 128);
+
     return 0;
 }
@@ -3,6 +3,45 @@
 
 using namespace ok;
 
+static int live_trackers = 0;
+static int tracker_copies = 0;
+
+// Owns a heap allocation, so copying or relocating it with memcpy would free it twice
+struct Tracker {
+    explicit Tracker(int value) : value{new int(value)} {
+        live_trackers++;
+    }
+
+    Tracker(const Tracker& other) : value{new int(*other.value)} {
+        live_trackers++;
+        tracker_copies++;
+    }
+
+    Tracker(Tracker&& other) : value{other.value} {
+        other.value = nullptr;
+        live_trackers++;
+    }
+
+    Tracker& operator =(Tracker&& other) {
+        delete value;
+        value = other.value;
+        other.value = nullptr;
+        return *this;
+    }
+
+    ~Tracker() {
+        delete value;
+        live_trackers--;
+    }
+
+    int* value;
+};
+
+struct Pair2 {
+    int a;
+    int b;
+};
+
 int main() {
     size_t ints_cap = 90;
 
@@ -19,5 +58,112 @@ int main() {
 
     OK_ASSERT(ints.capacity == OK_LIST_GROW_FACTOR(ints_cap));
 
+    int more[1000];
+    for (int i = 0; i < 1000; i++) more[i] = i;
+
+    size_t old_count = ints.count;
+    ints.append_many(more, 1000);
+
+    OK_ASSERT(ints.count == old_count + 1000);
+    OK_ASSERT(ints.capacity == ints.count);
+    OK_ASSERT(ints[old_count + 999] == 999);
+
+    List<int> copied = ints.copy(temp_allocator, old_count);
+    OK_ASSERT(copied.count == 1000 && copied[0] == 0);
+
+    copied.extend(ints.slice(0, 10));
+    OK_ASSERT(copied.count == 1010 && copied[1000] == 0 && copied[1009] == 9);
+
+    copied.remove_at(0);
+    OK_ASSERT(copied.count == 1009 && copied[0] == 1 && copied[998] == 999);
+
+    List<String> strings = List<String>::alloc(temp_allocator, 1);
+    String owned[2] = {String::alloc(temp_allocator, "first"), String::alloc(temp_allocator, "second")};
+    strings.append_many(owned, 2);
+    strings.remove_at(0);
+    OK_ASSERT(strings.count == 1 && strings[0] == "second"_sv);
+
+    {
+        List<Tracker> trackers = List<Tracker>::alloc(temp_allocator, 2);
+
+        for (int i = 0; i < 100; i++) trackers.emplace(i);
+        trackers.push(Tracker{100});
+
+        OK_ASSERT(trackers.count == 101);
+        OK_ASSERT(live_trackers == 101);
+        OK_ASSERT(tracker_copies == 0);
+
+        trackers.push(trackers[0]);
+        OK_ASSERT(tracker_copies == 1 && *trackers[101].value == 0);
+
+        // emplacing from an item while the list grows
+        size_t filled = trackers.count;
+        while (trackers.count < trackers.capacity) trackers.emplace(0);
+        trackers.emplace(trackers[1]);
+        OK_ASSERT(tracker_copies == 2 && *trackers[trackers.count - 1].value == 1);
+        while (trackers.count > filled) trackers.remove_at(trackers.count - 1);
+
+        trackers.remove_at(0);
+        OK_ASSERT(live_trackers == 101 && *trackers[0].value == 1);
+
+        trackers.free();
+        OK_ASSERT(live_trackers == 0);
+    }
+
+    List<List<int>> nested = List<List<int>>::alloc(temp_allocator, 1);
+    nested.push(List<int>::alloc(temp_allocator));
+    nested.emplace(List<int>::alloc(temp_allocator));
+    nested[1].push(5);
+    OK_ASSERT(nested.count == 2 && nested[1][0] == 5);
+
+    List<Pair2> pairs = List<Pair2>::alloc(temp_allocator);
+    Pair2& pair = pairs.emplace(1, 2);
+    OK_ASSERT(pair.a == 1 && pair.b == 2);
+
+    {
+        // appending a list to itself reads from the buffer that the growth moves.
+        // The pool reuses the old block right away, so a stale read shows up
+        PoolAllocator pool{};
+        auto self = List<int>::alloc(&pool, 4);
+        for (int i = 0; i < 4; i++) self.push(i);
+        self.extend(self.slice());
+        self.extend(self.slice(6));
+        OK_ASSERT(self.count == 10);
+
+        int expected[] = {0, 1, 2, 3, 0, 1, 2, 3, 2, 3};
+        for (size_t i = 0; i < self.count; i++) OK_ASSERT(self[i] == expected[i]);
+        self.free();
+
+        auto trackers = List<Tracker>::alloc(&pool, 2);
+        trackers.emplace(1);
+        trackers.emplace(2);
+        trackers.extend(trackers.slice());
+        OK_ASSERT(trackers.count == 4 && *trackers[2].value == 1 && *trackers[3].value == 2);
+        trackers.free();
+        OK_ASSERT(live_trackers == 0);
+        pool.free();
+    }
+
+    {
+        ArenaAllocator arena{};
+        auto ints = List<int, ArenaAllocator>::alloc(&arena, 1);
+        for (int i = 0; i < 1000; i++) ints.push(i);
+        OK_ASSERT(ints.count == 1000 && ints[999] == 999);
+
+        // the list is the only thing in the arena, so every growth happened in place
+        OK_ASSERT(arena.used() == align_to(ints.capacity * sizeof(int), sizeof(void*)));
+
+        auto copy = ints.copy(&arena, 10, 20);
+        OK_ASSERT(copy.allocator == &arena && copy.count == 10 && copy[0] == 10);
+
+        auto trackers = List<Tracker, ArenaAllocator>::alloc(&arena, 1);
+        for (int i = 0; i < 50; i++) trackers.emplace(i);
+        OK_ASSERT(live_trackers == 50 && *trackers[49].value == 49);
+        trackers.free();
+        OK_ASSERT(live_trackers == 0);
+
+        arena.free();
+    }
+
     return 0;
 }
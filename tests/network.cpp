@@ -0,0 +1,159 @@
+#define OK_IMPLEMENTATION
+#include "../ok.hpp"
+
+using namespace ok;
+
+// Writes until the socket would block, returning the unwritten part
+static StringView write_some(const Socket& socket, StringView sv) {
+    while (sv.count > 0) {
+        size_t n;
+        auto err = socket.write(sv, &n);
+
+        if (err.has_value()) {
+            OK_ASSERT(err.get() == Socket::Error::WOULD_BLOCK);
+            break;
+        }
+
+        sv = StringView{sv.data + n, sv.count - n};
+    }
+
+    return sv;
+}
+
+int main() {
+    Address parsed;
+    OK_ASSERT(!Address::parse(&parsed, "127.0.0.1", 8080).has_value());
+    OK_ASSERT(parsed.port() == 8080 && !parsed.is_ipv6());
+    OK_ASSERT(!Address::parse(&parsed, "::1", 80).has_value());
+    OK_ASSERT(parsed.is_ipv6());
+    OK_ASSERT(Address::parse(&parsed, "not an address", 80).has_value());
+
+    Socket listener;
+    OK_ASSERT(!Socket::listen(&listener, Address::loopback(0)).has_value());
+
+    Address bound;
+    OK_ASSERT(!listener.local_address(&bound).has_value());
+    OK_ASSERT(bound.port() != 0);
+
+    Socket empty;
+    auto accept_err = listener.accept(&empty);
+    OK_ASSERT(accept_err.has_value() && accept_err.get() == Socket::Error::WOULD_BLOCK);
+
+    EventLoop loop;
+    OK_ASSERT(!EventLoop::init(&loop, static_allocator).has_value());
+    OK_ASSERT(!loop.add(listener, EventLoop::READABLE, &listener).has_value());
+
+#if OK_LINUX
+    {
+        // epoll refuses regular files, which has to come back as an error rather than a panic
+        File file;
+        OK_ASSERT(!File::open(&file, __FILE__).has_value());
+
+        Socket not_a_socket{};
+        not_a_socket.handle = file.fd;
+        auto add_err = loop.add(not_a_socket, EventLoop::READABLE, nullptr);
+        OK_ASSERT(add_err.has_value() && add_err.get() == EventLoop::Error::UNSUPPORTED_HANDLE);
+
+        file.close();
+        not_a_socket.handle = file.fd;
+        add_err = loop.add(not_a_socket, EventLoop::READABLE, nullptr);
+        OK_ASSERT(add_err.has_value() && add_err.get() == EventLoop::Error::INVALID_HANDLE);
+    }
+#endif // OK_LINUX
+
+    Socket client;
+    OK_ASSERT(!Socket::connect(&client, bound).has_value());
+    OK_ASSERT(!loop.add(client, EventLoop::WRITABLE, &client).has_value());
+
+    Connection conn{};
+    bool accepted = false;
+    bool connected = false;
+    EventLoop::Event events[8];
+
+    while (!accepted || !connected) {
+        size_t n;
+        OK_ASSERT(!loop.wait(events, OK_ARR_LEN(events), 1000, &n).has_value());
+        OK_ASSERT(n > 0);
+
+        for (size_t i = 0; i < n; i++) {
+            if (events[i].user_data == &listener) {
+                Socket socket;
+                OK_ASSERT(!listener.accept(&socket).has_value());
+                Connection::init(&conn, socket);
+                OK_ASSERT(!loop.add(conn.socket, EventLoop::READABLE, &conn).has_value());
+                accepted = true;
+            } else if (events[i].user_data == &client && (events[i].flags & EventLoop::WRITABLE)) {
+                OK_ASSERT(!client.connect_result().has_value());
+                connected = true;
+            }
+        }
+    }
+
+    loop.remove(client);
+
+    // bigger than a single read so the receive buffer has to grow
+    String message = String::alloc(static_allocator);
+    for (size_t i = 0; i < 10'000; i++) message.append("hello, server! "_sv);
+    StringView unsent = message.view();
+
+    while (conn.data().count < message.view().count) {
+        unsent = write_some(client, unsent);
+
+        size_t n;
+        OK_ASSERT(!loop.wait(events, OK_ARR_LEN(events), 1000, &n).has_value());
+        OK_ASSERT(n > 0);
+
+        for (size_t i = 0; i < n; i++) {
+            if (events[i].user_data == &conn) OK_ASSERT(!conn.receive().has_value());
+        }
+    }
+
+    OK_ASSERT(conn.view() == message.view());
+    conn.consume(15);
+    OK_ASSERT(conn.view().count == message.view().count - 15);
+
+    conn.reset();
+    OK_ASSERT(conn.data().count == 0);
+
+    client.close();
+
+    while (!conn.peer_closed) {
+        size_t n;
+        OK_ASSERT(!loop.wait(events, OK_ARR_LEN(events), 1000, &n).has_value());
+        OK_ASSERT(n > 0);
+        OK_ASSERT(!conn.receive().has_value());
+    }
+
+    loop.remove(conn.socket);
+    conn.close();
+
+    Socket receiver;
+    OK_ASSERT(!Socket::listen(&receiver, Address::loopback(0), Socket::Type::UDP).has_value());
+    OK_ASSERT(!receiver.local_address(&bound).has_value());
+
+    Socket sender;
+    OK_ASSERT(!Socket::open(&sender, false, Socket::Type::UDP).has_value());
+
+    size_t sent;
+    OK_ASSERT(!sender.send_to((const uint8_t*)"ping", 4, bound, &sent).has_value());
+    OK_ASSERT(sent == 4);
+
+    OK_ASSERT(!loop.add(receiver, EventLoop::READABLE, &receiver).has_value());
+
+    size_t n;
+    OK_ASSERT(!loop.wait(events, OK_ARR_LEN(events), 1000, &n).has_value());
+    OK_ASSERT(n == 1 && events[0].user_data == &receiver);
+
+    uint8_t datagram[16];
+    size_t received;
+    Address from;
+    OK_ASSERT(!receiver.recv_from(datagram, sizeof(datagram), &from, &received).has_value());
+    OK_ASSERT(received == 4 && memcmp(datagram, "ping", 4) == 0);
+
+    sender.close();
+    receiver.close();
+    listener.close();
+    loop.deinit();
+
+    return 0;
+}
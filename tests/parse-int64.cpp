@@ -0,0 +1,45 @@
+#define OK_IMPLEMENTATION
+#include "../ok.hpp"
+
+using namespace ok;
+
+int main() {
+    int64_t i64;
+
+    OK_ASSERT(parse_int64("0"_sv, &i64) && i64 == 0);
+    OK_ASSERT(parse_int64("12345"_sv, &i64) && i64 == 12345);
+    OK_ASSERT(parse_int64("-12345"_sv, &i64) && i64 == -12345);
+    OK_ASSERT(parse_int64("9223372036854775807"_sv, &i64) && i64 == INT64_MAX);
+    OK_ASSERT(parse_int64("-9223372036854775808"_sv, &i64) && i64 == INT64_MIN);
+
+    OK_ASSERT(!parse_int64(""_sv, &i64));
+    OK_ASSERT(!parse_int64("-"_sv, &i64));
+    OK_ASSERT(!parse_int64("12a"_sv, &i64));
+    OK_ASSERT(!parse_int64("9223372036854775808"_sv, &i64));
+    OK_ASSERT(!parse_int64("-9223372036854775809"_sv, &i64));
+
+    uint64_t u64;
+
+    OK_ASSERT(parse_uint64("18446744073709551615"_sv, &u64) && u64 == UINT64_MAX);
+    OK_ASSERT(!parse_uint64("18446744073709551616"_sv, &u64));
+    OK_ASSERT(!parse_uint64("-1"_sv, &u64));
+
+    double f64;
+
+    OK_ASSERT(parse_double("1.5"_sv, &f64) && f64 == 1.5);
+    OK_ASSERT(parse_double("-0.25e2"_sv, &f64) && f64 == -25.0);
+    OK_ASSERT(parse_double(".5"_sv, &f64) && f64 == 0.5);
+    OK_ASSERT(parse_double("0.1"_sv, &f64) && f64 == 0.1);
+    OK_ASSERT(parse_double("1e-300"_sv, &f64) && f64 == 1e-300);
+    OK_ASSERT(parse_double("123456789012345678901234567890"_sv, &f64) && f64 == 123456789012345678901234567890.0);
+    OK_ASSERT(parse_double("inf"_sv, &f64) && std::isinf(f64));
+    OK_ASSERT(parse_double("nan"_sv, &f64) && std::isnan(f64));
+
+    OK_ASSERT(!parse_double(""_sv, &f64));
+    OK_ASSERT(!parse_double("."_sv, &f64));
+    OK_ASSERT(!parse_double("1e"_sv, &f64));
+    OK_ASSERT(!parse_double("1.5x"_sv, &f64));
+    OK_ASSERT(!parse_double("1e999"_sv, &f64));
+
+    return 0;
+}
@@ -0,0 +1,48 @@
+#define OK_IMPLEMENTATION
+#include "../ok.hpp"
+
+using namespace ok;
+
+int main() {
+    PoolAllocator pool{};
+
+    OK_ASSERT(PoolAllocator::size_class(1) == 0);
+    OK_ASSERT(PoolAllocator::size_class(16) == 0);
+    OK_ASSERT(PoolAllocator::size_class(17) == 1);
+    OK_ASSERT(PoolAllocator::size_class(PoolAllocator::MAX_BLOCK_SIZE) == PoolAllocator::SIZE_CLASS_COUNT - 1);
+
+    int* first = pool.alloc<int>(10);
+    OK_ASSERT(first != nullptr);
+
+    pool.dealloc(first, 10);
+
+    int* second = pool.alloc<int>(12);
+    OK_ASSERT(second == first);
+
+    uint8_t* big = pool.alloc<uint8_t>(PoolAllocator::MAX_BLOCK_SIZE * 4);
+    OK_ASSERT(big != nullptr);
+    memset(big, 0xAA, PoolAllocator::MAX_BLOCK_SIZE * 4);
+    pool.dealloc(big, PoolAllocator::MAX_BLOCK_SIZE * 4);
+
+    List<size_t> list = List<size_t>::alloc(&pool);
+    for (size_t i = 0; i < 10'000; i++) list.push(i);
+    for (size_t i = 0; i < 10'000; i++) OK_ASSERT(list[i] == i);
+
+    // a freed list has no block to resize, growing it has to allocate a new one
+    auto reused = List<int>::alloc(&pool, 4);
+    reused.push(1);
+    reused.free();
+    reused.push(2);
+    OK_ASSERT(reused.items != nullptr && reused.count == 1 && reused[0] == 2);
+    reused.free();
+
+    void* fresh = pool.raw_resize(nullptr, 0, 8);
+    OK_ASSERT(fresh != nullptr);
+    pool.raw_dealloc(fresh, 8);
+
+    pool.free();
+
+    OK_ASSERT(pool.chunks == nullptr);
+
+    return 0;
+}
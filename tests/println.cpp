@@ -0,0 +1,81 @@
+#define OK_IMPLEMENTATION
+#include "../ok.hpp"
+
+#include <sys/wait.h>
+
+using namespace ok;
+
+static StringView read_back(File* file, char* buf, size_t size) {
+    size_t n;
+    OK_ASSERT(!file->read_at((uint8_t*)buf, size, 0, &n).has_value());
+    return StringView{buf, n};
+}
+
+// Runs after the main thread's buffer is destroyed
+struct Logger {
+    ~Logger() {
+        println("println: static destructors can still print");
+        flush_output();
+    }
+};
+
+static Logger logger;
+
+int main() {
+    const char* path = "println.test.tmp";
+    File file;
+    OK_ASSERT(!File::create(&file, path).has_value());
+
+    fflush(stdout);
+    int saved_stdout = dup(1);
+    int saved_stderr = dup(2);
+    dup2(file.fd, 1);
+    dup2(file.fd, 2);
+
+    // a line printed after the interval goes out right away
+    output_flush_interval_ns = 0;
+    println("first");
+
+    char buf[256];
+    OK_ASSERT(read_back(&file, buf, sizeof(buf)) == "first\n"_sv);
+
+    // never flush on time, so the test does not depend on how fast it runs
+    output_flush_interval_ns = UINT64_MAX;
+
+    String owned = String::alloc(temp_allocator, "second");
+    println(owned);
+    println("third"_sv);
+    OK_ASSERT(read_back(&file, buf, sizeof(buf)) == "first\n"_sv);
+
+    // stderr lines flush the buffered stdout lines first
+    eprintln("error"_sv);
+    OK_ASSERT(read_back(&file, buf, sizeof(buf)) == "first\nsecond\nthird\nerror\n"_sv);
+
+    println("fourth");
+    flush_output();
+
+    dup2(saved_stdout, 1);
+    dup2(saved_stderr, 2);
+    close(saved_stdout);
+    close(saved_stderr);
+
+    OK_ASSERT(read_back(&file, buf, sizeof(buf)) == "first\nsecond\nthird\nerror\nfourth\n"_sv);
+
+    // a failed assertion writes out the buffered lines before aborting
+    pid_t child = fork();
+    if (child == 0) {
+        dup2(file.fd, 1);
+        dup2(file.fd, 2);
+        println("last words");
+        OK_ASSERT(false);
+    }
+
+    int status;
+    OK_ASSERT(waitpid(child, &status, 0) == child && WIFSIGNALED(status));
+    OK_ASSERT(read_back(&file, buf, sizeof(buf)).starts_with("first\nsecond\nthird\nerror\nfourth\nlast words\n"_sv));
+
+    file.close();
+    remove(path);
+
+    return 0;
+}
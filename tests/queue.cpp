@@ -0,0 +1,141 @@
+#define OK_IMPLEMENTATION
+#include "../ok.hpp"
+
+#include <thread>
+
+using namespace ok;
+
+static constexpr size_t ITEMS_PER_PRODUCER = 20'000;
+static constexpr size_t PRODUCER_COUNT = 4;
+static constexpr size_t CONSUMER_COUNT = 4;
+
+static void spsc_produce(SpscQueue<size_t>* queue) {
+    size_t batch[16];
+    size_t next = 0;
+
+    while (next < ITEMS_PER_PRODUCER) {
+        size_t n = 0;
+        while (n < 16 && next + n < ITEMS_PER_PRODUCER) {
+            batch[n] = next + n;
+            n++;
+        }
+
+        size_t pushed = queue->push_n(Slice<size_t>{batch, n});
+        if (pushed == 0) std::this_thread::yield();
+        next += pushed;
+    }
+}
+
+static void mpmc_produce(MpmcQueue<size_t>* queue, size_t producer) {
+    size_t base = producer * ITEMS_PER_PRODUCER;
+
+    for (size_t i = 0; i < ITEMS_PER_PRODUCER;) {
+        if (i % 2 == 0) {
+            size_t batch[3] = {base + i, base + i + 1, base + i + 2};
+            size_t n = ITEMS_PER_PRODUCER - i < 3 ? ITEMS_PER_PRODUCER - i : 3;
+            i += queue->push_n(Slice<size_t>{batch, n});
+        } else if (queue->push(base + i)) {
+            i++;
+        } else {
+            std::this_thread::yield();
+        }
+    }
+}
+
+static void mpmc_consume(MpmcQueue<size_t>* queue, std::atomic<size_t>* consumed, uint8_t* seen) {
+    size_t batch[8];
+
+    while (consumed->load() < PRODUCER_COUNT * ITEMS_PER_PRODUCER) {
+        Slice<size_t> popped = queue->pop_n(batch, 8);
+
+        if (popped.count == 0) std::this_thread::yield();
+        for (size_t i = 0; i < popped.count; i++) seen[popped[i]]++;
+        consumed->fetch_add(popped.count);
+    }
+}
+
+int main() {
+    SpscQueue<String> strings;
+    SpscQueue<String>::init(&strings, temp_allocator, 3);
+
+    OK_ASSERT(strings.mask == 3);
+    OK_ASSERT(strings.push(String::alloc(temp_allocator, "one")));
+    OK_ASSERT(strings.push(String::alloc(temp_allocator, "two")));
+    OK_ASSERT(strings.push(String::alloc(temp_allocator, "three")));
+    OK_ASSERT(strings.push(String::alloc(temp_allocator, "four")));
+    OK_ASSERT(!strings.push(String::alloc(temp_allocator, "five")));
+    OK_ASSERT(strings.count() == 4);
+
+    String popped;
+    OK_ASSERT(strings.pop(&popped) && popped == "one"_sv);
+
+    String out[4];
+    Slice<String> rest = strings.pop_n(out, 4);
+    OK_ASSERT(rest.count == 3 && rest[0] == "two"_sv && rest[2] == "four"_sv);
+    OK_ASSERT(!strings.pop(&popped));
+    strings.free();
+
+    SpscQueue<size_t> spsc;
+    SpscQueue<size_t>::init(&spsc, temp_allocator, 64);
+
+    std::thread producer{spsc_produce, &spsc};
+
+    size_t expected = 0;
+    size_t batch[8];
+
+    while (expected < ITEMS_PER_PRODUCER) {
+        Slice<size_t> got = spsc.pop_n(batch, 8);
+        if (got.count == 0) std::this_thread::yield();
+        for (size_t i = 0; i < got.count; i++) OK_ASSERT(got[i] == expected++);
+    }
+
+    producer.join();
+    spsc.free();
+
+    MpmcQueue<int> ints;
+    MpmcQueue<int>::init(&ints, temp_allocator, 4);
+
+    int values[] = {1, 2, 3, 4, 5};
+    OK_ASSERT(ints.push_n(Slice<int>{values, 5}) == 4);
+    OK_ASSERT(!ints.push(6));
+
+    int value;
+    OK_ASSERT(ints.pop(&value) && value == 1);
+    OK_ASSERT(ints.push(6));
+
+    int drained[8];
+    Slice<int> all = ints.pop_n(drained, 8);
+    OK_ASSERT(all.count == 4 && all[0] == 2 && all[3] == 6);
+    OK_ASSERT(!ints.pop(&value));
+    ints.free();
+
+    MpmcQueue<size_t> mpmc;
+    MpmcQueue<size_t>::init(&mpmc, temp_allocator, 128);
+
+    uint8_t* seen[CONSUMER_COUNT];
+    std::atomic<size_t> consumed{0};
+    std::thread producers[PRODUCER_COUNT];
+    std::thread consumers[CONSUMER_COUNT];
+
+    for (size_t i = 0; i < CONSUMER_COUNT; i++) {
+        seen[i] = (uint8_t*)calloc(PRODUCER_COUNT * ITEMS_PER_PRODUCER, 1);
+        consumers[i] = std::thread{mpmc_consume, &mpmc, &consumed, seen[i]};
+    }
+
+    for (size_t i = 0; i < PRODUCER_COUNT; i++) producers[i] = std::thread{mpmc_produce, &mpmc, i};
+
+    for (auto& thread : producers) thread.join();
+    for (auto& thread : consumers) thread.join();
+
+    // every item came out exactly once
+    for (size_t item = 0; item < PRODUCER_COUNT * ITEMS_PER_PRODUCER; item++) {
+        size_t times = 0;
+        for (size_t i = 0; i < CONSUMER_COUNT; i++) times += seen[i][item];
+        OK_ASSERT(times == 1);
+    }
+
+    for (size_t i = 0; i < CONSUMER_COUNT; i++) ::free(seen[i]);
+    mpmc.free();
+
+    return 0;
+}
@@ -0,0 +1,153 @@
+#define OK_IMPLEMENTATION
+#include "../ok.hpp"
+
+using namespace ok;
+
+struct Entry {
+    int key;
+    int order;
+};
+
+static ArenaAllocator arena_impl{};
+static Allocator* arena = &arena_impl;
+
+static uint64_t rng_state = 0x9E3779B97F4A7C15ull;
+
+static uint64_t next_random() {
+    rng_state ^= rng_state << 13;
+    rng_state ^= rng_state >> 7;
+    rng_state ^= rng_state << 17;
+    return rng_state;
+}
+
+template <typename T>
+static bool is_sorted(const T* items, size_t count) {
+    for (size_t i = 1; i < count; i++) {
+        if (items[i] < items[i - 1]) return false;
+    }
+    return true;
+}
+
+static void check_sorts(int* items, size_t count) {
+    int* copy = arena->alloc<int>(count);
+
+    memcpy(copy, items, count * sizeof(int));
+    sort(copy, count);
+    OK_ASSERT(is_sorted(copy, count));
+
+    memcpy(copy, items, count * sizeof(int));
+    stable_sort(copy, count, arena);
+    OK_ASSERT(is_sorted(copy, count));
+
+    memcpy(copy, items, count * sizeof(int));
+    radix_sort(copy, count, arena);
+    OK_ASSERT(is_sorted(copy, count));
+}
+
+int main() {
+    static constexpr size_t N = 10000;
+
+    int* items = arena->alloc<int>(N);
+
+    for (size_t i = 0; i < N; i++) items[i] = (int)next_random();
+    check_sorts(items, N);
+    check_sorts(items, 20);
+    check_sorts(items, 1);
+    check_sorts(items, 0);
+
+    for (size_t i = 0; i < N; i++) items[i] = (int)i;
+    check_sorts(items, N);
+
+    for (size_t i = 0; i < N; i++) items[i] = (int)(N - i);
+    check_sorts(items, N);
+
+    for (size_t i = 0; i < N; i++) items[i] = 7;
+    check_sorts(items, N);
+
+    for (size_t i = 0; i < N; i++) items[i] = (int)(next_random() % 4) - 2;
+    check_sorts(items, N);
+
+    // a sawtooth, which makes naive quicksort pick bad pivots
+    for (size_t i = 0; i < N; i++) items[i] = (int)(i % 64);
+    check_sorts(items, N);
+
+    List<int> ints = List<int>::alloc(arena, 4);
+    ints.push(3);
+    ints.push(-1);
+    ints.push(2);
+    ints.push(-5);
+
+    ints.sort([](int a, int b) { return a > b; });
+    OK_ASSERT(ints[0] == 3 && ints[1] == 2 && ints[2] == -1 && ints[3] == -5);
+
+    ints.radix_sort(arena);
+    OK_ASSERT(ints[0] == -5 && ints[1] == -1 && ints[2] == 2 && ints[3] == 3);
+
+    List<Entry> entries = List<Entry>::alloc(arena, 1000);
+    for (int i = 0; i < 1000; i++) entries.push(Entry{(int)(next_random() % 10), i});
+
+    auto by_key = [](const Entry& a, const Entry& b) { return a.key < b.key; };
+
+    List<Entry> merged = entries.copy(arena);
+    merged.stable_sort(arena, by_key);
+
+    for (size_t i = 1; i < merged.count; i++) {
+        OK_ASSERT(merged[i - 1].key <= merged[i].key);
+        if (merged[i - 1].key == merged[i].key) OK_ASSERT(merged[i - 1].order < merged[i].order);
+    }
+
+    List<Entry> radixed = entries.copy(arena);
+    radix_sort(radixed.items, radixed.count, arena, [](const Entry& e) { return e.key; });
+
+    for (size_t i = 0; i < radixed.count; i++) {
+        OK_ASSERT(radixed[i].key == merged[i].key && radixed[i].order == merged[i].order);
+    }
+
+    uint64_t* wide = arena->alloc<uint64_t>(N);
+    for (size_t i = 0; i < N; i++) wide[i] = next_random();
+    radix_sort(wide, N, arena);
+    OK_ASSERT(is_sorted(wide, N));
+
+    StringView words[] = {
+        "pear"_sv, "apple"_sv, ""_sv, "app"_sv, "banana"_sv, "apples"_sv, "b"_sv, "pear"_sv,
+    };
+    radix_sort(words, 8, arena);
+    OK_ASSERT(words[0] == ""_sv && words[1] == "app"_sv && words[2] == "apple"_sv);
+    OK_ASSERT(words[3] == "apples"_sv && words[4] == "b"_sv && words[5] == "banana"_sv);
+    OK_ASSERT(words[6] == "pear"_sv && words[7] == "pear"_sv);
+
+    List<StringView> views = List<StringView>::alloc(arena, 2000);
+    for (size_t i = 0; i < 2000; i++) {
+        size_t length = next_random() % 40;
+        char* chars = arena->alloc<char>(length);
+        for (size_t j = 0; j < length; j++) chars[j] = "abc"[next_random() % 3];
+        views.push(StringView{chars, length});
+    }
+
+    List<StringView> compared = views.copy(arena);
+    compared.sort();
+    views.radix_sort(arena);
+
+    OK_ASSERT(is_sorted(views.items, views.count));
+    for (size_t i = 0; i < views.count; i++) OK_ASSERT(views[i] == compared[i]);
+
+    int sorted[] = {1, 3, 3, 3, 5, 8};
+    Slice<int> slice{sorted, 6};
+
+    OK_ASSERT(slice.lower_bound(3) == 1);
+    OK_ASSERT(slice.upper_bound(3) == 4);
+    OK_ASSERT(slice.lower_bound(0) == 0);
+    OK_ASSERT(slice.lower_bound(9) == 6);
+    OK_ASSERT(slice.lower_bound(4) == 4);
+    OK_ASSERT(slice.binary_search(8));
+    OK_ASSERT(!slice.binary_search(4));
+    Slice<int> empty{sorted, 0};
+    OK_ASSERT(empty.lower_bound(1) == 0);
+
+    Slice<StringView> word_slice{words, 8};
+    OK_ASSERT(word_slice.lower_bound("apple"_sv) == 2);
+    OK_ASSERT(word_slice.binary_search("banana"_sv));
+    OK_ASSERT(!word_slice.binary_search("cherry"_sv));
+
+    return 0;
+}
@@ -0,0 +1,54 @@
+#define OK_IMPLEMENTATION
+#include "../ok.hpp"
+
+using namespace ok;
+
+int main() {
+    auto interner = StringInterner::alloc(static_allocator, 4);
+
+    Symbol hello = interner.intern("hello"_sv);
+    Symbol world = interner.intern("world"_sv);
+    Symbol empty = interner.intern(""_sv);
+
+    OK_ASSERT(hello.id == 0 && world.id == 1 && empty.id == 2);
+    OK_ASSERT(interner.intern("hello"_sv) == hello);
+    OK_ASSERT(interner.intern(""_sv) == empty);
+    OK_ASSERT(hello != world);
+    OK_ASSERT(interner.count() == 3);
+
+    // the interner keeps its own copy of the bytes
+    char buffer[] = "world";
+    OK_ASSERT(interner.intern(StringView{buffer, 5}) == world);
+    buffer[0] = 'W';
+    OK_ASSERT(interner.view(world) == "world"_sv);
+    OK_ASSERT(interner.view(world).data != buffer);
+    OK_ASSERT(interner.view(empty).count == 0);
+
+    OK_ASSERT(interner.find("hello"_sv).get() == hello);
+    OK_ASSERT(!interner.find("nope"_sv).has_value());
+    OK_ASSERT(interner.count() == 3);
+
+    // growing the table and the list must keep ids and views stable
+    for (size_t i = 0; i < 10'000; i++) {
+        String name = format(static_allocator, "identifier_{}", i % 2'500);
+        Symbol symbol = interner.intern(name.view());
+        OK_ASSERT(symbol.id == 3 + i % 2'500);
+        OK_ASSERT(interner.view(symbol) == name.view());
+        name.free();
+    }
+
+    OK_ASSERT(interner.count() == 2'503);
+    OK_ASSERT(interner.view(hello) == "hello"_sv);
+
+    auto counts = Table<Symbol, int>::alloc(static_allocator);
+    StringView words[] = {"a"_sv, "b"_sv, "a"_sv};
+    for (auto word : words) (*counts.get_or_insert(interner.intern(word), 0))++;
+
+    OK_ASSERT(counts.get(interner.intern("a"_sv)).get() == 2);
+    OK_ASSERT(counts.get(interner.intern("b"_sv)).get() == 1);
+
+    counts.free();
+    interner.free();
+
+    return 0;
+}
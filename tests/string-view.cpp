@@ -3,9 +3,69 @@
 
 using namespace ok;
 
+static size_t naive_find(StringView haystack, StringView needle, size_t start) {
+    for (size_t i = start; i + needle.count <= haystack.count; i++) {
+        if (haystack.view(i, i + needle.count) == needle) return i;
+    }
+
+    return StringView::NPOS;
+}
+
 int main() {
 #define CSTR_LITERAL "hello"
     StringView sv = "hello"_sv;
     OK_ASSERT(sv.count = strlen(CSTR_LITERAL));
     OK_ASSERT(strcmp((const char*)sv.data, CSTR_LITERAL) == 0);
+
+    OK_ASSERT(sv.find('l') == 2);
+    OK_ASSERT(sv.find('l', 3) == 3);
+    OK_ASSERT(sv.find('z') == StringView::NPOS);
+    OK_ASSERT(sv.find("llo"_sv) == 2);
+    OK_ASSERT(sv.find(""_sv) == 0);
+    OK_ASSERT(sv.find("hello!"_sv) == StringView::NPOS);
+    OK_ASSERT(sv.find_any_of("ol"_sv) == 2);
+    OK_ASSERT(sv.count_of('l') == 2);
+    OK_ASSERT(sv.contains("ell"_sv) && !sv.contains('x'));
+    OK_ASSERT(sv.starts_with("he"_sv) && sv.ends_with("lo"_sv) && !sv.ends_with("he"_sv));
+
+    // long enough to go through the block loops and their tails
+    char text[301];
+    for (size_t i = 0; i < 300; i++) text[i] = "abcdefg"[i % 7];
+    text[300] = '\0';
+    text[250] = 'X';
+    text[251] = 'Y';
+
+    StringView long_sv{text};
+    OK_ASSERT(long_sv.find('X') == 250);
+    OK_ASSERT(long_sv.find("XY"_sv) == 250);
+    OK_ASSERT(long_sv.find_any_of("YX"_sv) == 250);
+    OK_ASSERT(long_sv.find_any_of("0123456789XY"_sv) == 250);
+
+    StringView needles[] = {"abc"_sv, "gab"_sv, "fgXY"_sv, "YcdefgAbc"_sv, "defgabcdefgabcdefgabcdefgabcdefg"_sv};
+    for (StringView needle : needles) {
+        for (size_t start = 0; start < 40; start++) {
+            OK_ASSERT(long_sv.find(needle, start) == naive_find(long_sv, needle, start));
+        }
+    }
+
+    size_t a_count = 0;
+    for (size_t i = 0; i < long_sv.count; i++) a_count += text[i] == 'a';
+    OK_ASSERT(long_sv.count_of('a') == a_count);
+
+    StringView fields[5];
+    size_t field_count = 0;
+
+    auto split = "a,b,,c,"_sv.split(',');
+    for (StringView field; split.next(&field);) fields[field_count++] = field;
+
+    OK_ASSERT(field_count == 5);
+    OK_ASSERT(fields[0] == "a"_sv && fields[1] == "b"_sv && fields[2] == ""_sv);
+    OK_ASSERT(fields[3] == "c"_sv && fields[4] == ""_sv);
+
+    field_count = 0;
+    auto lines = "one\r\ntwo\r\nthree"_sv.split("\r\n"_sv);
+    for (StringView field; lines.next(&field);) fields[field_count++] = field;
+
+    OK_ASSERT(field_count == 3);
+    OK_ASSERT(fields[0] == "one"_sv && fields[1] == "two"_sv && fields[2] == "three"_sv);
 }
@@ -27,4 +27,31 @@ int main() {
     message.format_append(" from %s", obviously_the_best_language);
 
     OK_ASSERT(strcmp(message.cstr(), hello_world " and friends from C++") == 0);
+
+    String empty{};
+    OK_ASSERT(empty.is_inline() && empty.count() == 0 && strcmp(empty.cstr(), "") == 0);
+
+    String small = String::alloc(a);
+    for (size_t i = 0; i < String::INLINE_CAPACITY; i++) small.push('a' + (char)i);
+
+    OK_ASSERT(small.is_inline());
+    OK_ASSERT(small.count() == String::INLINE_CAPACITY);
+    OK_ASSERT(small.cstr()[String::INLINE_CAPACITY] == String::NULL_CHAR);
+
+    String spilled = small.copy(a);
+    spilled.push('!');
+
+    OK_ASSERT(!spilled.is_inline());
+    OK_ASSERT(spilled.count() == String::INLINE_CAPACITY + 1);
+    OK_ASSERT(spilled.starts_with(small.view()));
+    OK_ASSERT(spilled.view(0, small.count()) == small);
+
+    List<char> chars = List<char>::alloc(a);
+    for (const char* c = "list"; *c != String::NULL_CHAR; c++) chars.push(*c);
+
+    String from_list = String::from(chars);
+    OK_ASSERT(from_list.is_inline() && from_list == "list"_sv);
+
+    spilled.free();
+    OK_ASSERT(spilled.is_inline() && spilled.count() == 0);
 }
@@ -0,0 +1,180 @@
+#define OK_IMPLEMENTATION
+#include "../ok.hpp"
+
+using namespace ok;
+
+template <TableLayout LAYOUT>
+static void check_layout() {
+    auto tab = Table<uint32_t, uint64_t, LAYOUT>::alloc(static_allocator);
+
+    for (uint32_t i = 0; i < 5'000; i++) tab.put(i, (uint64_t)i * 3);
+    for (uint32_t i = 0; i < 5'000; i += 3) tab.remove(i);
+    tab.rehash();
+
+    size_t visited = 0;
+    uint64_t key_sum = 0;
+
+    auto it = tab.iter();
+    for (typename decltype(it)::Entry entry; it.next(&entry);) {
+        OK_ASSERT(*entry.value == (uint64_t)*entry.key * 3);
+        key_sum += *entry.key;
+        visited++;
+
+        // values can be updated in place
+        *entry.value = *entry.key;
+    }
+
+    uint64_t expected_sum = 0;
+    for (uint32_t i = 0; i < 5'000; i++) {
+        if (i % 3 != 0) expected_sum += i;
+    }
+
+    OK_ASSERT(visited == tab.count);
+    OK_ASSERT(key_sum == expected_sum);
+
+    for (uint32_t i = 0; i < 5'000; i++) {
+        OK_ASSERT(tab.has(i) == (i % 3 != 0));
+        if (i % 3 != 0) OK_ASSERT(tab.get(i).get() == i);
+    }
+
+    tab.free();
+}
+
+// The macro has to work on dependent tables and with any binding names
+template <typename K, typename V>
+static V sum_values(const Table<K, V>& tab) {
+    V sum{};
+    OK_TABLE_FOREACH(tab, k, v, {
+        OK_UNUSED(k);
+        static_assert(std::is_const<typename std::remove_reference<decltype(v)>::type>::value, "");
+        sum += v;
+    });
+    return sum;
+}
+
+int main() {
+    check_layout<TableLayout::SOA>();
+    check_layout<TableLayout::AOS>();
+
+    auto empty = Table<int, int>{};
+    auto empty_it = empty.iter();
+    decltype(empty_it)::Entry empty_entry;
+    OK_ASSERT(!empty_it.next(&empty_entry));
+
+    auto tab = Table<size_t, size_t>::alloc(static_allocator, 10);
+
+    OK_ASSERT(tab.capacity == TableGroup::WIDTH);
+
+    for (size_t i = 0; i < 10'000; i++) tab.put(i, i * 2);
+
+    OK_ASSERT(tab.count == 10'000);
+    OK_ASSERT((tab.capacity & (tab.capacity - 1)) == 0);
+
+    for (size_t i = 0; i < 10'000; i++) {
+        auto value = tab.get(i);
+        OK_ASSERT(value.has_value());
+        OK_ASSERT(value.get() == i * 2);
+    }
+
+    OK_ASSERT(!tab.has(10'000));
+    OK_ASSERT(!tab.get(123'456).has_value());
+
+    tab.put(5, 55);
+    OK_ASSERT(tab.get(5).get() == 55);
+    OK_ASSERT(tab.count == 10'000);
+
+    for (size_t i = 0; i < 10'000; i += 2) OK_ASSERT(tab.remove(i));
+    OK_ASSERT(!tab.remove(0));
+    OK_ASSERT(tab.count == 5'000);
+
+    for (size_t i = 0; i < 10'000; i++) OK_ASSERT(tab.has(i) == (i % 2 == 1));
+
+    tab.rehash();
+    OK_ASSERT(tab.deleted == 0);
+    for (size_t i = 0; i < 10'000; i++) OK_ASSERT(tab.has(i) == (i % 2 == 1));
+
+    // churning through keys must not keep growing the table
+    size_t capacity = tab.capacity;
+    for (size_t i = 0; i < 100'000; i++) {
+        tab.put(20'000 + i, i);
+        tab.remove(20'000 + i);
+    }
+    OK_ASSERT(tab.capacity == capacity);
+    OK_ASSERT(tab.count == 5'000);
+
+    PoolAllocator pool{};
+    auto presized = Table<uint32_t, uint32_t>::alloc(&pool);
+    presized.reserve(1000);
+    capacity = presized.capacity;
+    for (uint32_t i = 0; i < 1000; i++) presized.put(i, i);
+    OK_ASSERT(presized.capacity == capacity);
+    presized.free();
+    pool.free();
+
+    auto strings = Table<StringView, int>::alloc(static_allocator);
+    strings.put("one"_sv, 1);
+    strings.put("two"_sv, 2);
+    strings.put("three"_sv, 3);
+
+    OK_ASSERT(strings.get("two"_sv).get() == 2);
+    OK_ASSERT(!strings.has("four"_sv));
+
+    size_t sum = 0;
+    OK_TABLE_FOREACH(strings, key, value, { OK_UNUSED(key); sum += value; });
+    OK_ASSERT(sum == 6);
+
+    OK_TABLE_FOREACH(strings, key, value, { OK_UNUSED(key); value *= 10; });
+    OK_ASSERT(strings.get("three"_sv).get() == 30);
+    OK_ASSERT(sum_values(strings) == 60);
+
+    int doubled = 0;
+    OK_TABLE_FOREACH(strings, name, number, { OK_UNUSED(name); number *= 2; doubled += number; });
+    OK_ASSERT(doubled == 120);
+
+    auto owned = Table<String, int>::alloc(static_allocator);
+    owned.put(String::alloc(static_allocator, "hello"), 1);
+    owned.put(String::alloc(static_allocator, "world"), 2);
+
+    OK_ASSERT(owned.get("hello"_sv).get() == 1);
+    OK_ASSERT(owned.has("world"_sv));
+    OK_ASSERT(!owned.has("nope"_sv));
+
+    StringView words[] = {"a"_sv, "b"_sv, "a"_sv, "c"_sv, "a"_sv};
+    auto counts = Table<StringView, int>::alloc(static_allocator);
+    for (auto word : words) (*counts.get_or_insert(word, 0))++;
+
+    OK_ASSERT(counts.get("a"_sv).get() == 3);
+    OK_ASSERT(counts.get("c"_sv).get() == 1);
+    OK_ASSERT(counts.get_ptr("d"_sv) == nullptr);
+
+    *counts.get_ptr("b"_sv) = 10;
+    OK_ASSERT(counts.get("b"_sv).get() == 10);
+
+    OK_ASSERT(owned.remove("hello"_sv));
+    OK_ASSERT(!owned.has("hello"_sv));
+
+    {
+        ArenaAllocator arena{};
+        auto tab = Table<uint32_t, uint32_t, TableLayout::SOA, ArenaAllocator>::alloc(&arena, 8);
+        for (uint32_t i = 0; i < 1000; i++) tab.put(i, i + 1);
+
+        OK_ASSERT(tab.allocator == &arena && tab.count == 1000);
+        for (uint32_t i = 0; i < 1000; i++) OK_ASSERT(tab.get(i).get() == i + 1);
+
+        tab.free();
+        arena.free();
+    }
+
+    auto set = Set<uint32_t>::alloc(static_allocator);
+    for (uint32_t i = 0; i < 1000; i += 2) set.put(i);
+    set.put(10);
+
+    OK_ASSERT(set.count == 500);
+    for (uint32_t i = 0; i < 1000; i++) OK_ASSERT(set.has(i) == (i % 2 == 0));
+
+    for (uint32_t i = 0; i < 1000; i += 4) OK_ASSERT(set.remove(i));
+    set.rehash();
+    for (uint32_t i = 0; i < 1000; i++) OK_ASSERT(set.has(i) == (i % 4 == 2));
+
+    return 0;
+}
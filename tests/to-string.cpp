@@ -1,6 +1,8 @@
 #define OK_IMPLEMENTATION
 #include "../ok.hpp"
 
+#include <clocale>
+
 using namespace ok;
 
 int main() {
@@ -15,5 +17,62 @@ int main() {
     OK_ASSERT(strcmp(to_string(temp_allocator, u64).cstr(), "10000000000") == 0);
     OK_ASSERT(strcmp(to_string(temp_allocator, i64).cstr(), "-10000000000") == 0);
 
+    OK_ASSERT(to_string(temp_allocator, (uint64_t)0) == "0"_sv);
+    OK_ASSERT(to_string(temp_allocator, UINT64_MAX) == "18446744073709551615"_sv);
+    OK_ASSERT(to_string(temp_allocator, INT64_MIN) == "-9223372036854775808"_sv);
+
+    char buf[MAX_INT_CHARS];
+    for (uint64_t value = 1; value < UINT64_MAX / 10; value = value * 10 + 7) {
+        size_t n = to_chars(buf, value);
+        uint64_t parsed;
+
+        OK_ASSERT(parse_uint64(StringView{buf, n}, &parsed) && parsed == value);
+    }
+
+    OK_ASSERT(to_string(temp_allocator, 1.5) == "1.5"_sv);
+    OK_ASSERT(to_string(temp_allocator, 0.1) == "0.1"_sv);
+    OK_ASSERT(to_string(temp_allocator, 3.0) == "3"_sv);
+    OK_ASSERT(to_string(temp_allocator, -0.0) == "-0"_sv);
+    OK_ASSERT(to_string(temp_allocator, 1e300) == "1e+300"_sv);
+    OK_ASSERT(to_string(temp_allocator, HUGE_VAL) == "inf"_sv);
+
+    double doubles[] = {0.1 + 0.2, 1.0 / 3.0, 2.5e-308, 123456.789, -9007199254740993.0};
+    for (double value : doubles) {
+        String s = to_string(temp_allocator, value);
+        double parsed;
+
+        OK_ASSERT(parse_double(s.view(), &parsed) && parsed == value);
+    }
+
+    String line = String::alloc(temp_allocator);
+    line.append("requests="_sv);
+    line.append_uint(42);
+    line.append(" delta="_sv);
+    line.append_int(-7);
+    line.append(" ratio="_sv);
+    line.append_double(0.75);
+
+    OK_ASSERT(line == "requests=42 delta=-7 ratio=0.75"_sv);
+
+    // decimal-comma locales must not leak into the output or the parser, when one is installed
+    const char* comma_locales[] = {"de_DE.UTF-8", "de_DE.utf8", "fr_FR.UTF-8", "fr_FR.utf8", "German_Germany.1252"};
+    for (const char* name : comma_locales) {
+        if (setlocale(LC_NUMERIC, name) == nullptr) continue;
+
+        OK_ASSERT(to_string(temp_allocator, 1.5) == "1.5"_sv);
+        OK_ASSERT(to_string(temp_allocator, 0.1 + 0.2) == "0.30000000000000004"_sv);
+
+        double parsed;
+        OK_ASSERT(parse_double("1.5"_sv, &parsed) && parsed == 1.5);
+        OK_ASSERT(parse_double("1.2345678901234567890123"_sv, &parsed) && parsed == 1.2345678901234567);
+
+        setlocale(LC_NUMERIC, "C");
+        break;
+    }
+
+    double tiny;
+    OK_ASSERT(parse_double("1e-400"_sv, &tiny) && tiny == 0.0);
+    OK_ASSERT(!parse_double("1e400"_sv, &tiny));
+
     return 0;
 }
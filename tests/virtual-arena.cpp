@@ -0,0 +1,66 @@
+#define OK_IMPLEMENTATION
+#include "../ok.hpp"
+
+using namespace ok;
+
+int main() {
+    VirtualArenaAllocator arena{};
+
+    int* first = arena.alloc<int>(4);
+    OK_ASSERT(first != nullptr);
+    OK_ASSERT(arena.reserved == VirtualArenaAllocator::DEFAULT_RESERVE_SIZE);
+    OK_ASSERT(arena.committed == VirtualArenaAllocator::COMMIT_GRANULARITY);
+
+    int* second = arena.alloc<int>(4);
+    OK_ASSERT((uint8_t*)second == (uint8_t*)first + 4 * sizeof(int));
+
+    // the last block grows in place, committing pages as it goes
+    size_t big = 10 * VirtualArenaAllocator::COMMIT_GRANULARITY / sizeof(int);
+    int* grown = arena.resize(second, 4, big);
+    OK_ASSERT(grown == second);
+    OK_ASSERT(arena.committed >= arena.off);
+    for (size_t i = 0; i < big; i++) grown[i] = (int)i;
+
+    arena.dealloc(grown, big);
+    OK_ASSERT(arena.off == align_to(4 * sizeof(int), sizeof(void*)));
+
+    arena.decommit();
+    OK_ASSERT(arena.committed == VirtualArenaAllocator::COMMIT_GRANULARITY);
+
+    // a list that owns the top of the arena never has to copy its items
+    auto list = List<uint64_t>::alloc(&arena, 16);
+    uint64_t* items = list.items;
+    for (uint64_t i = 0; i < 1'000'000; i++) list.push(i);
+    OK_ASSERT(list.items == items);
+    OK_ASSERT(list[999'999] == 999'999);
+
+    {
+        Allocator::Scope scope{&arena};
+        arena.alloc<uint8_t>(100);
+    }
+    OK_ASSERT((uint8_t*)arena.base + arena.off == (uint8_t*)(list.items + list.capacity));
+
+    arena.reset();
+    OK_ASSERT(arena.off == 0);
+    arena.free();
+    OK_ASSERT(arena.base == nullptr);
+
+    VirtualArenaAllocator small{};
+    OK_ASSERT(!VirtualArenaAllocator::init(&small, 1 << 20).has_value());
+    OK_ASSERT(small.alloc<uint8_t>(1 << 20) != nullptr);
+    OK_ASSERT(small.alloc<uint8_t>(1) == nullptr);
+    small.free();
+
+    VirtualArenaAllocator huge{};
+    OK_ASSERT(!VirtualArenaAllocator::init(&huge, (size_t)1 << 30, true).has_value());
+    uint8_t* bytes = huge.alloc<uint8_t>(3 << 20);
+    OK_ASSERT(bytes != nullptr);
+#if OK_UNIX
+    OK_ASSERT((uintptr_t)huge.base % VirtualArenaAllocator::HUGE_PAGE_SIZE == 0);
+    OK_ASSERT(huge.committed == 2 * VirtualArenaAllocator::HUGE_PAGE_SIZE);
+#endif // OK_UNIX
+    memset(bytes, 1, 3 << 20);
+    huge.free();
+
+    return 0;
+}